@@ -0,0 +1,63 @@
+#shader vertex
+#version 450 core
+
+layout(location = 0) in vec4 a_Position;
+layout(location = 1) in vec4 a_Color;
+layout(location = 2) in vec2 a_TexCoord;
+layout(location = 3) in float a_TexIndex;
+
+out vec4 v_Color;
+out vec2 v_TexCoord;
+flat out int v_TexIndex;
+
+void main()
+{
+   v_Color = a_Color;
+   v_TexCoord = a_TexCoord;
+   v_TexIndex = int(a_TexIndex);
+   gl_Position = a_Position;
+};
+
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+in vec2 v_TexCoord;
+flat in int v_TexIndex;
+
+// texture units 0..15, BatchRenderer2D::MaxTextureSlots
+layout(binding = 0) uniform sampler2D u_Textures[16];
+
+void main()
+{
+	// v_TexIndex differs between fragments, and a sampler array may only be
+	// indexed with a dynamically uniform value. Each case indexes it with a
+	// constant instead; the derivatives are taken outside the branches.
+	vec2 dx = dFdx(v_TexCoord);
+	vec2 dy = dFdy(v_TexCoord);
+	vec4 texColor;
+	switch (v_TexIndex)
+	{
+		case 0: texColor = textureGrad(u_Textures[0], v_TexCoord, dx, dy); break;
+		case 1: texColor = textureGrad(u_Textures[1], v_TexCoord, dx, dy); break;
+		case 2: texColor = textureGrad(u_Textures[2], v_TexCoord, dx, dy); break;
+		case 3: texColor = textureGrad(u_Textures[3], v_TexCoord, dx, dy); break;
+		case 4: texColor = textureGrad(u_Textures[4], v_TexCoord, dx, dy); break;
+		case 5: texColor = textureGrad(u_Textures[5], v_TexCoord, dx, dy); break;
+		case 6: texColor = textureGrad(u_Textures[6], v_TexCoord, dx, dy); break;
+		case 7: texColor = textureGrad(u_Textures[7], v_TexCoord, dx, dy); break;
+		case 8: texColor = textureGrad(u_Textures[8], v_TexCoord, dx, dy); break;
+		case 9: texColor = textureGrad(u_Textures[9], v_TexCoord, dx, dy); break;
+		case 10: texColor = textureGrad(u_Textures[10], v_TexCoord, dx, dy); break;
+		case 11: texColor = textureGrad(u_Textures[11], v_TexCoord, dx, dy); break;
+		case 12: texColor = textureGrad(u_Textures[12], v_TexCoord, dx, dy); break;
+		case 13: texColor = textureGrad(u_Textures[13], v_TexCoord, dx, dy); break;
+		case 14: texColor = textureGrad(u_Textures[14], v_TexCoord, dx, dy); break;
+		case 15: texColor = textureGrad(u_Textures[15], v_TexCoord, dx, dy); break;
+		default: texColor = vec4(1.0); break;
+	}
+	color = texColor * v_Color;
+};
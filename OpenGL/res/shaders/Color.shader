@@ -0,0 +1,12 @@
+#shader fragment
+#version 410 core
+
+// only the fragment stage, combined with a vertex stage in a ProgramPipeline
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+   color = u_Color;
+};
\ No newline at end of file
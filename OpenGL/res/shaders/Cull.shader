@@ -0,0 +1,109 @@
+#shader compute
+#version 450 core
+
+layout(local_size_x = 64) in;
+
+struct CullObject
+{
+   vec4 Sphere;  // xyz = center, w = radius
+   uint IndexCount;
+   uint FirstIndex;
+   int BaseVertex;
+   uint Padding;
+};
+
+struct DrawCommand
+{
+   uint Count;
+   uint InstanceCount;
+   uint FirstIndex;
+   int BaseVertex;
+   uint BaseInstance;
+};
+
+layout(std140, binding = 0) uniform CullParams
+{
+   vec4 u_Planes[6];
+   mat4 u_HiZViewProj;  // view-projection the pyramid was rendered with
+   vec4 u_HiZSize;      // xy = level 0 size, z = level count
+   uint u_ObjectCount;
+   uint u_UseHiZ;
+};
+
+layout(std430, binding = 0) readonly buffer Objects
+{
+   CullObject u_Objects[];
+};
+
+layout(std430, binding = 1) writeonly buffer Commands
+{
+   DrawCommand u_Commands[];
+};
+
+layout(std430, binding = 2) buffer DrawCount
+{
+   uint u_DrawCount;
+};
+
+// max depth pyramid of the previous frame
+layout(binding = 0) uniform sampler2D u_HiZ;
+
+bool IsOccluded(vec3 center, float radius)
+{
+   vec2 minUV = vec2(1.0);
+   vec2 maxUV = vec2(0.0);
+   float minDepth = 1.0;
+   for (int i = 0; i < 8; i++)
+   {
+      vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+      vec4 clip = u_HiZViewProj * vec4(corner, 1.0);
+      // crosses the camera plane, can't be projected
+      if (clip.w <= 0.0)
+         return false;
+      vec3 ndc = clip.xyz / clip.w;
+      minUV = min(minUV, ndc.xy * 0.5 + 0.5);
+      maxUV = max(maxUV, ndc.xy * 0.5 + 0.5);
+      minDepth = min(minDepth, ndc.z * 0.5 + 0.5);
+   }
+   minUV = clamp(minUV, 0.0, 1.0);
+   maxUV = clamp(maxUV, 0.0, 1.0);
+
+   // level where the bounds cover at most 2x2 texels
+   vec2 size = (maxUV - minUV) * u_HiZSize.xy;
+   float level = min(ceil(log2(max(max(size.x, size.y), 1.0))), u_HiZSize.z - 1.0);
+   // one level finer often still does, and its texels reach less past the bounds
+   if (level > 0.0)
+   {
+      vec2 finerSize = vec2(textureSize(u_HiZ, int(level) - 1));
+      vec2 texels = floor(min(maxUV * finerSize, finerSize - 1.0)) - floor(minUV * finerSize);
+      if (texels.x <= 1.0 && texels.y <= 1.0)
+         level -= 1.0;
+   }
+
+   float depth = max(max(textureLod(u_HiZ, minUV, level).r, textureLod(u_HiZ, vec2(maxUV.x, minUV.y), level).r),
+                     max(textureLod(u_HiZ, vec2(minUV.x, maxUV.y), level).r, textureLod(u_HiZ, maxUV, level).r));
+   return minDepth > depth;
+}
+
+void main()
+{
+   uint index = gl_GlobalInvocationID.x;
+   if (index >= u_ObjectCount)
+      return;
+
+   CullObject object = u_Objects[index];
+   vec3 center = object.Sphere.xyz;
+   float radius = object.Sphere.w;
+
+   for (int i = 0; i < 6; i++)
+   {
+      if (dot(u_Planes[i].xyz, center) + u_Planes[i].w < -radius)
+         return;
+   }
+   if (u_UseHiZ != 0u && IsOccluded(center, radius))
+      return;
+
+   // BaseInstance carries the object index to the vertex shader (gl_BaseInstance)
+   uint slot = atomicAdd(u_DrawCount, 1u);
+   u_Commands[slot] = DrawCommand(object.IndexCount, 1u, object.FirstIndex, object.BaseVertex, index);
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#shader vertex
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout(location = 0) in vec4 a_Position;
+
+struct CullObject
+{
+   vec4 Sphere;
+   uint IndexCount;
+   uint FirstIndex;
+   int BaseVertex;
+   uint Padding;
+};
+
+layout(std430, binding = 0) readonly buffer Objects
+{
+   CullObject u_Objects[];
+};
+
+layout(std140, binding = 1) uniform Camera
+{
+   mat4 u_ViewProj;
+};
+
+flat out vec4 v_Color;
+
+void main()
+{
+   // the culling pass stores the object index in BaseInstance
+   vec4 sphere = u_Objects[gl_BaseInstanceARB].Sphere;
+#ifdef COLOR_BY_INDEX
+   // a color of its own for every object, to tell them apart
+   v_Color = vec4(fract(vec3(gl_BaseInstanceARB) * vec3(0.13, 0.37, 0.71)), 1.0);
+#else
+   v_Color = vec4(0.2, 0.6 + 0.1 * sphere.x, 0.9, 1.0);
+#endif
+   gl_Position = u_ViewProj * vec4(sphere.xy + a_Position.xy * sphere.w, sphere.z, 1.0);
+};
+
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+flat in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+};
\ No newline at end of file
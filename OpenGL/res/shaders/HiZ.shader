@@ -0,0 +1,40 @@
+#shader compute
+#version 450 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// level 0 reads the depth texture, every other level the level above it
+layout(binding = 0) uniform sampler2D u_Depth;
+layout(r32f, binding = 1) uniform readonly image2D u_Previous;
+layout(r32f, binding = 0) uniform writeonly image2D u_Destination;
+
+// x = 1 when reading u_Depth
+uniform vec4 u_Params;
+
+float Fetch(ivec2 texel)
+{
+   if (u_Params.x > 0.5)
+      return texelFetch(u_Depth, texel, 0).r;
+   return imageLoad(u_Previous, texel).r;
+}
+
+void main()
+{
+   ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+   ivec2 size = imageSize(u_Destination);
+   if (any(greaterThanEqual(texel, size)))
+      return;
+
+   // source texels covered by this one; with odd sizes the last texel takes the extra row/column
+   ivec2 sourceSize = u_Params.x > 0.5 ? textureSize(u_Depth, 0) : imageSize(u_Previous);
+   ivec2 begin = texel * sourceSize / size;
+   ivec2 end = max((texel + 1) * sourceSize / size, begin + 1);
+
+   float depth = 0.0;
+   for (int y = begin.y; y < end.y; y++)
+   {
+      for (int x = begin.x; x < end.x; x++)
+         depth = max(depth, Fetch(ivec2(x, y)));
+   }
+   imageStore(u_Destination, texel, vec4(depth));
+};
\ No newline at end of file
@@ -0,0 +1,39 @@
+#shader vertex
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout(location = 0) in vec4 a_Position;
+
+struct DrawData
+{
+   vec4 OffsetScale;  // xy = offset, zw = scale
+   vec4 Color;
+};
+
+// one entry per draw of the glMultiDrawElementsIndirect call
+layout(std430, binding = 0) readonly buffer DrawDataBlock
+{
+   DrawData u_Draws[];
+};
+
+flat out vec4 v_Color;
+
+void main()
+{
+   DrawData draw = u_Draws[gl_DrawIDARB];
+   v_Color = draw.Color;
+   gl_Position = vec4(a_Position.xy * draw.OffsetScale.zw + draw.OffsetScale.xy, 0.0, 1.0);
+};
+
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+flat in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+};
\ No newline at end of file
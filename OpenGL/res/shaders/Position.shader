@@ -0,0 +1,16 @@
+#shader vertex
+#version 410 core
+
+// only the vertex stage, combined with a fragment stage in a ProgramPipeline
+layout(location = 0) in vec4 position;
+
+// separable programs have to declare the built-in block they write
+out gl_PerVertex
+{
+   vec4 gl_Position;
+};
+
+void main()
+{
+   gl_Position = position;
+};
\ No newline at end of file
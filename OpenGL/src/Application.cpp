@@ -5,43 +5,155 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 
 #include "Renderer.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "Material.h"
+#include "BatchRenderer2D.h"
+#include "Framebuffer.h"
+#include "HeadlessContext.h"
+#include "Profiler.h"
+#include "NullGL.h"
+#include "DrawIndirectBuffer.h"
+#include "GpuCulling.h"
+#include "UniformBuffer.h"
+#include "ShaderWatcher.h"
+#include "ShaderLibrary.h"
+#include "ProgramPipeline.h"
 
-int main(void)
+// Indirect.shaderin DrawData (std430)
+struct IndirectDrawData
 {
-    GLFWwindow* window;
+    float OffsetScale[4];
+    float Color[4];
+};
 
-    /* Initialize the library */
-    if (!glfwInit())
-        return -1;
+struct AppOptions
+{
+    bool Headless = false;    // --headless: EGL context, render into a Framebuffer
+    bool Null = false;        // --null: no context, GL calls go to NullGL (CPU cost only)
+    int Frames = 600;         // --frames N: frames to render without a window
+    std::string Output;       // --output file.ppm: last headless frame
+    std::string Trace;        // --trace file.json: Chrome trace of every frame
+    bool Profile = false;     // --profile: print the profiled frame tree on exit
+    int StatsInterval = 0;    // --stats N: print renderer stats every N frames
+    bool Watch = false;       // --watch: reload .shader files when they are saved
+    bool IndexColors = false; // --object-colors: a color of its own for every culled object
+    bool Pipeline = false;    // --pipeline: draw the quad with separable vertex and fragment programs
+    bool NoDSA = false;       // --no-dsa: set up buffers and vertex arrays by binding them, as before GL 4.5
+    bool NoOcclusion = false; // --no-occlusion: headless culling only against the view frustum
+};
+
+static AppOptions ParseOptions(int argc, char** argv)
+{
+    AppOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+            options.Headless = true;
+        else if (strcmp(argv[i], "--null") == 0)
+            options.Null = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            options.Frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            options.Output = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            options.Trace = argv[++i];
+        else if (strcmp(argv[i], "--profile") == 0)
+            options.Profile = true;
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+            options.StatsInterval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--watch") == 0)
+            options.Watch = true;
+        else if (strcmp(argv[i], "--object-colors") == 0)
+            options.IndexColors = true;
+        else if (strcmp(argv[i], "--pipeline") == 0)
+            options.Pipeline = true;
+        else if (strcmp(argv[i], "--no-dsa") == 0)
+            options.NoDSA = true;
+        else if (strcmp(argv[i], "--no-occlusion") == 0)
+            options.NoOcclusion = true;
+        else
+            std::cout << "Unknown option " << argv[i] << std::endl;
+    }
+    return options;
+}
+
+int main(int argc, char** argv)
+{
+    AppOptions options = ParseOptions(argc, argv);
+    const int width = 640, height = 480;
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    GLFWwindow* window = nullptr;
+    HeadlessContext headless;
+    // ei ikkunaa: piirretn Framebufferiin annettu mr frameja
+    const bool offscreen = options.Headless || options.Null;
 
-    /* Create a windowed mode window and its OpenGL context */
-    window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
-    if (!window)
+    if (options.Null)
     {
-        glfwTerminate();
-        return -1;
+        NullGL::Install();
+    }
+    else if (options.Headless)
+    {
+        if (!headless.Create(4, 6, GL_CHECK_LEVEL == GL_CHECK_CALLBACK))
+            return -1;
     }
+    else
+    {
+        /* Initialize the library */
+        if (!glfwInit())
+            return -1;
 
-    /* Make the window's context current */
-    glfwMakeContextCurrent(window);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GL_CHECK_LEVEL == GL_CHECK_CALLBACK
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
 
-    glfwSwapInterval(2);
+        /* Create a windowed mode window and its OpenGL context */
+        window = glfwCreateWindow(width, height, "Hello World", NULL, NULL);
+        if (!window)
+        {
+            glfwTerminate();
+            return -1;
+        }
 
-    if (glewInit() != GLEW_OK)
-        std::cout << "Error!" << std::endl;
+        /* Make the window's context current */
+        glfwMakeContextCurrent(window);
+
+        glfwSwapInterval(2);
+    }
+
+    // ilman X: GLX-nytt ei ole, mutta GL-funktiot ladataan silti
+    if (!options.Null)
+    {
+        GLenum glewError = glewInit();
+        if (glewError != GLEW_OK && !(options.Headless && glewError == GLEW_ERROR_NO_GLX_DISPLAY))
+            std::cout << "Error!" << std::endl;
+    }
 
     std::cout << glGetString(GL_VERSION) << std::endl;
 
+#if GL_CHECK_LEVEL == GL_CHECK_CALLBACK
+    if (!GLEnableDebugOutput())
+        std::cout << "Debug output not available, checking errors with glGetError" << std::endl;
+#endif
+
+    Renderer::SetDirectStateAccess(!options.NoDSA);
+    Profiler::Init(true);
+    if (!options.Trace.empty() && !Profiler::BeginTrace(options.Trace))
+        std::cout << "Can't write " << options.Trace << std::endl;
+
     // blokin ansiosta ohjelma lopetetaan kun piirtmisikkuna on suljetaan
     // muuten tulee gl Error koska ei ole kontekstia
     {
@@ -58,11 +170,6 @@ int main(void)
             2, 3, 0
         };
 
-        // vertex array object id
-        unsigned int vao;
-        GLCall(glGenVertexArrays(1, &vao));  // luodaan yksi array ja tallennetaan sen id vao:on
-        GLCall(glBindVertexArray(vao));
-
         VertexArray va;
         VertexBuffer vb(positions, 4 * 2 * sizeof(float));
         VertexBufferLayout layout;
@@ -71,61 +178,220 @@ int main(void)
 
 
         IndexBuffer ib(indices, 6);
+        va.SetIndexBuffer(ib);
 
-        Shader shader("res/shaders/Basic.shader");
-        shader.Bind();
+        std::shared_ptr<Shader> shader = ShaderLibrary::Load("res/shaders/Basic.shader");
+        shader->Bind();
 
-        shader.SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
+        shader->SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
 
         va.Unbind();
         vb.Unbind();
         ib.Unbind();
-        shader.Unbind();
-        GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-        GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+        shader->Unbind();
+
+        Renderer renderer;
+        Renderer::SetStatsPrintInterval(options.StatsInterval);
+        Material material;
+        const UniformHandle colorUniform("u_Color");
+
+        const int gridSize = 320;  // 320 * 320 = 102400 quads
+        // koko framen nelit mahtuvat yhteen puskurin alueeseen
+        BatchRenderer2D batch(gridSize * gridSize);
+        const float cellSize = 2.0f / gridSize;
+
+        // rivi pieni neliit yhdell glMultiDrawElementsIndirect-kutsulla
+        std::shared_ptr<Shader> indirectShader = ShaderLibrary::Load("res/shaders/Indirect.shader");
+        const unsigned int indirectQuads = 8;
+        DrawIndirectBuffer indirect(indirectQuads, sizeof(IndirectDrawData));
+
+        // objektiruudukko maailmassa, GPU karsii kameran ulkopuolelle jvt
+        const int cullGridSize = 24;
+        std::vector<CullObject> cullObjects;
+        for (int y = 0; y < cullGridSize; y++)
+        {
+            for (int x = 0; x < cullGridSize; x++)
+                cullObjects.push_back({ { -3.0f + (x + 0.5f) * 0.25f, -3.0f + (y + 0.5f) * 0.25f, 0.5f }, 0.1f, ib.GetCount(), 0, 0, 0 });
+        }
+        GpuCulling culling((unsigned int)cullObjects.size());
+        culling.SetObjects(cullObjects.data(), (unsigned int)cullObjects.size());
+        ShaderDefines culledDefines;
+        if (options.IndexColors)
+            culledDefines.Set("COLOR_BY_INDEX");
+        std::shared_ptr<Shader> culledShader = ShaderLibrary::Load("res/shaders/Culled.shader", culledDefines);
+        UniformBuffer cameraBuffer(GL_UNIFORM_BUFFER, 256);
+
+        // erilliset vaiheet yhdistetn pipelineksi ilman uutta linkityst
+        std::shared_ptr<Shader> colorStage;
+        std::unique_ptr<ProgramPipeline> pipeline;
+        if (options.Pipeline)
+        {
+            colorStage = ShaderLibrary::LoadSeparable("res/shaders/Color.shader");
+            pipeline = std::make_unique<ProgramPipeline>(std::initializer_list<std::shared_ptr<Shader>>{
+                ShaderLibrary::LoadSeparable("res/shaders/Position.shader"), colorStage });
+        }
+
+        ShaderWatcher shaderWatcher;
+        if (options.Watch)
+        {
+            for (const std::shared_ptr<Shader>& variant : ShaderLibrary::GetShaders())
+                shaderWatcher.Watch(variant);
+        }
+
+        // headless: ei oletus-framebufferia, piirretn omaan
+        std::unique_ptr<Framebuffer> framebuffer;
+        // edellisen framen syvyys; ikkunan oletus-framebufferin syvyytt ei voi lukea
+        std::unique_ptr<HiZPyramid> hiz;
+        if (offscreen)
+        {
+            framebuffer = std::make_unique<Framebuffer>(width, height);
+            framebuffer->Bind();
+            if (!options.NoOcclusion)
+                hiz = std::make_unique<HiZPyramid>(width, height);
+
+            // --frames 1 --output: ensimminenkin frame piirretn valmiilla ohjelmilla
+            for (const std::shared_ptr<Shader>& variant : ShaderLibrary::GetShaders())
+                variant->Wait();
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        int frame = 0;
 
         float red = 0.0f;
         float red_increment = 0.05f;
 
         /* Loop until the user closes the window */
-        while (!glfwWindowShouldClose(window))
+        while (offscreen ? frame < options.Frames : !glfwWindowShouldClose(window))
         {
-            /* Render here */
-            GLCall(glClear(GL_COLOR_BUFFER_BIT));
+            // scope suljetaan ennen EndFramea
+            {
+                PROFILE_SCOPE("Frame");
+
+                // muokatut shaderit vaihtuvat vasta kun uusi ohjelma on linkitetty
+                shaderWatcher.Update();
+
+                /* Render here */
+                renderer.Clear();
+
+                float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+                {
+                    PROFILE_SCOPE("Batch");
+                    batch.Begin();
+                    for (int y = 0; y < gridSize; y++)
+                    {
+                        for (int x = 0; x < gridSize; x++)
+                        {
+                            float wave = 0.5f + 0.5f * sinf(time * 2.0f + (x + y) * 0.05f);
+                            batch.DrawQuad({ -1.0f + x * cellSize, -1.0f + y * cellSize }, { cellSize * 0.9f, cellSize * 0.9f },
+                                { wave * 0.2f, 0.1f, wave * 0.4f, 1.0f });
+                        }
+                    }
+                    batch.End();
+                }
+
+                // 2D-kamera kiert ympyr, matriisi sarakkeittain
+                const float viewProj[16] = {
+                    1.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f, 1.0f, 0.0f, 0.0f,
+                    0.0f, 0.0f, 1.0f, 0.0f,
+                    -1.5f * cosf(time * 0.5f), -1.5f * sinf(time * 0.5f), 0.0f, 1.0f
+                };
+                {
+                    PROFILE_SCOPE("Culling");
+                    culling.Cull(viewProj);
+                    cameraBuffer.Upload(1, viewProj, sizeof(viewProj));
+                    renderer.SetDepthTest(true);
+                    culling.Draw(va, ib, *culledShader);
+                    renderer.SetDepthTest(false);
+                    cameraBuffer.EndFrame();
+                }
+
+                {
+                    PROFILE_SCOPE("Indirect");
+                    if (indirect.Begin(indirectQuads))
+                    {
+                        for (unsigned int i = 0; i < indirectQuads; i++)
+                        {
+                            float wave = 0.5f + 0.5f * sinf(time * 3.0f + i * 0.8f);
+                            IndirectDrawData data = { { -0.875f + i * 0.25f, 0.85f, 0.15f, 0.15f }, { 1.0f, wave, 0.2f, 1.0f } };
+                            indirect.AddDraw({ ib.GetCount(), 1, 0, 0, 0 }, &data);
+                        }
+                        indirect.Submit(va, ib, *indirectShader);
+                    }
+                    indirect.EndFrame();
+                }
 
-            // 1. bind shader
-            shader.Bind();
-            shader.SetUniform4f("u_Color", red, 0.3f, 0.8f, 1.0f);
+                material.SetUniform4f(colorUniform, red, 0.3f, 0.8f, 1.0f);
 
-            // 2. bind vertex array
-            //GLCall(glBindVertexArray(vao));
-        
-            // bind vertex array
-            va.Bind();
+                // piirrot jonoon, Flush lajittelee ne ja piirt kaikki kerralla
+                {
+                    PROFILE_SCOPE("Flush");
+                    // keskimminen neli on objektien edess ja peitt ne
+                    renderer.SetDepthTest(true);
+                    if (pipeline)
+                    {
+                        material.Apply(*colorStage);
+                        renderer.Draw(va, ib, *pipeline);
+                    }
+                    else
+                        renderer.Submit(*shader, va, ib, &material);
+                    renderer.Flush();
+                    renderer.SetDepthTest(false);
+                }
 
-            // 3. bind index buffer
-            ib.Bind();
+                if (hiz)
+                {
+                    PROFILE_SCOPE("HiZ");
+                    // seuraava frame testaa objektit tmn framen syvyytt vasten
+                    hiz->Build(framebuffer->GetDepthAttachment());
+                    culling.SetHiZ(hiz.get(), viewProj);
+                }
 
-            // tm piirt sen mik on VIIMEISIMPN valittu eli BINDATTU ylempn
-            //glDrawArrays(GL_TRIANGLES, 0, 6);  // mit piirretn, mist indeksist aloitetaan, kuinka monta indeksi
-            GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));  // ei tarvitse laittaa pointteria iboon koska on bindattu
-            /* Swap front and back buffers */
+                if (red > 1.0f)
+                    red_increment = -0.05f;
+                else if (red < 0.0f)
+                    red_increment = 0.05f;
 
-            if (red > 1.0f)
-                red_increment = -0.05f;
-            else if (red < 0.0f)
-                red_increment = 0.05f;
+                red += red_increment;
 
-            red += red_increment;
+                if (window)
+                {
+                    PROFILE_SCOPE("SwapBuffers");
+                    /* Swap front and back buffers */
+                    glfwSwapBuffers(window);
 
-            glfwSwapBuffers(window);
+                    /* Poll for and process events */
+                    glfwPollEvents();
+                }
+            }
+            Profiler::EndFrame();
+            Renderer::EndFrame();
+            frame++;
+        }
+
+        if (offscreen)
+        {
+            GLCall(glFinish());
+            float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+            std::cout << frame << " frames in " << seconds << " s (" <<
+                (frame ? seconds * 1000.0f / frame : 0.0f) << " ms/frame)" << std::endl;
 
-            /* Poll for and process events */
-            glfwPollEvents();
+            std::cout << culling.ReadDrawCount() << " / " << culling.GetObjectCount() << " objects visible" << std::endl;
+
+            if (!options.Output.empty() && !framebuffer->WritePPM(options.Output))
+                std::cout << "Can't write " << options.Output << std::endl;
         }
+
+        if (options.Profile)
+            Profiler::PrintFrame(Profiler::GetLastFrame());
+        // kyselyt ja kirjaston shaderit poistetaan ennen kontekstia
+        Profiler::Shutdown();
+        ShaderLibrary::Shutdown();
     }
 
 
-    glfwTerminate();
+    if (window)
+        glfwTerminate();
+    NullGL::Uninstall();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <vector>
+
+#include "BatchRenderer2D.h"
+#include "Renderer.h"
+#include "ShaderLibrary.h"
+
+
+static std::vector<unsigned int> GenerateQuadIndices(unsigned int quadCount)
+{
+    std::vector<unsigned int> indices(quadCount * 6);
+    for (unsigned int i = 0; i < quadCount; i++)
+    {
+        unsigned int vertex = i * 4;
+        indices[i * 6 + 0] = vertex + 0;
+        indices[i * 6 + 1] = vertex + 1;
+        indices[i * 6 + 2] = vertex + 2;
+        indices[i * 6 + 3] = vertex + 2;
+        indices[i * 6 + 4] = vertex + 3;
+        indices[i * 6 + 5] = vertex + 0;
+    }
+    return indices;
+}
+
+BatchRenderer2D::BatchRenderer2D(unsigned int maxQuadsPerFrame)
+    : m_VertexBuffer(GL_ARRAY_BUFFER, (maxQuadsPerFrame > MaxQuads ? maxQuadsPerFrame : MaxQuads) * 4 * sizeof(QuadVertex)),
+      m_Shader(ShaderLibrary::Load("res/shaders/Batch.shader")), m_WhiteTexture(0),
+      m_VertexBase(nullptr), m_BaseVertex(0), m_QuadCount(0), m_BatchCapacity(0), m_DroppedQuads(0), m_TextureSlotCount(0)
+{
+    // Load() may only have started the build; the first frame's quads need the program
+    m_Shader->Wait();
+
+    VertexBufferLayout layout;
+    layout.Push<float>(2);  // position
+    layout.Push<float>(4);  // color
+    layout.Push<float>(2);  // texture coordinates
+    layout.Push<float>(1);  // texture slot
+    m_VertexArray.AddBuffer(m_VertexBuffer, layout);
+
+    std::vector<unsigned int> indices = GenerateQuadIndices(MaxQuads);
+    m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), MaxIndices);
+    m_VertexArray.SetIndexBuffer(*m_IndexBuffer);
+
+    // untextured quads sample this so the shader doesn't need a branch
+    unsigned int white = 0xFFFFFFFF;
+    GLCall(glGenTextures(1, &m_WhiteTexture));
+    Renderer::State().BindTexture(0, GL_TEXTURE_2D, m_WhiteTexture);
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+}
+
+BatchRenderer2D::~BatchRenderer2D()
+{
+    Renderer::State().DeleteTexture(m_WhiteTexture);
+}
+
+void BatchRenderer2D::Begin()
+{
+    m_DroppedQuads = 0;
+    StartBatch();
+}
+
+void BatchRenderer2D::DrawQuad(const Vec2& position, const Vec2& size, const Vec4& color, unsigned int texture)
+{
+    if (m_QuadCount == m_BatchCapacity)
+    {
+        Flush();
+        StartBatch();
+    }
+    if (m_BatchCapacity == 0)
+    {
+        m_DroppedQuads++;
+        return;
+    }
+
+    if (texture == 0)
+        texture = m_WhiteTexture;
+
+    unsigned int slot = 0;
+    while (slot < m_TextureSlotCount && m_TextureSlots[slot] != texture)
+        slot++;
+    if (slot == m_TextureSlotCount)
+    {
+        if (m_TextureSlotCount == MaxTextureSlots)
+        {
+            Flush();
+            StartBatch();
+            if (m_BatchCapacity == 0)
+            {
+                m_DroppedQuads++;
+                return;
+            }
+            slot = 0;
+        }
+        m_TextureSlots[slot] = texture;
+        m_TextureSlotCount = slot + 1;
+    }
+
+    const float x0 = position.x, y0 = position.y;
+    const float x1 = position.x + size.x, y1 = position.y + size.y;
+    const float texIndex = (float)slot;
+
+    QuadVertex* v = m_VertexBase + m_QuadCount * 4;
+    v[0] = { { x0, y0 }, { color.x, color.y, color.z, color.w }, { 0.0f, 0.0f }, texIndex };
+    v[1] = { { x1, y0 }, { color.x, color.y, color.z, color.w }, { 1.0f, 0.0f }, texIndex };
+    v[2] = { { x1, y1 }, { color.x, color.y, color.z, color.w }, { 1.0f, 1.0f }, texIndex };
+    v[3] = { { x0, y1 }, { color.x, color.y, color.z, color.w }, { 0.0f, 1.0f }, texIndex };
+
+    m_QuadCount++;
+}
+
+void BatchRenderer2D::End()
+{
+    Flush();
+    m_VertexBase = nullptr;
+    m_VertexBuffer.EndFrame();
+
+    if (m_DroppedQuads > 0)
+        std::cout << "BatchRenderer2D: " << m_DroppedQuads << " quads didn't fit in the frame and were dropped!" << std::endl;
+}
+
+void BatchRenderer2D::StartBatch()
+{
+    // The last batch of the frame only gets what is left of the region.
+    // Moving on to the next region here would wait for the GPU to finish
+    // with it, so a full region leaves the batch empty instead.
+    const unsigned int quadSize = 4 * sizeof(QuadVertex);
+    const unsigned int available = m_VertexBuffer.GetAvailable(sizeof(QuadVertex)) / quadSize;
+    m_BatchCapacity = available < MaxQuads ? available : MaxQuads;
+    m_QuadCount = 0;
+
+    unsigned int offset = 0;
+    void* data = nullptr;
+    if (m_BatchCapacity > 0)
+    {
+        data = m_VertexBuffer.Reserve(m_BatchCapacity * quadSize, sizeof(QuadVertex), offset);
+        ASSERT(data);
+    }
+    m_VertexBase = (QuadVertex*)data;
+    m_BaseVertex = offset / sizeof(QuadVertex);
+    m_TextureSlots[0] = m_WhiteTexture;
+    m_TextureSlotCount = 1;
+}
+
+void BatchRenderer2D::Flush()
+{
+    // without a reservation there is nothing to commit
+    if (m_BatchCapacity > 0)
+        m_VertexBuffer.Commit(m_QuadCount * 4 * sizeof(QuadVertex));
+    if (m_QuadCount == 0 || !m_Shader->IsReady())
+        return;
+
+    for (unsigned int i = 0; i < m_TextureSlotCount; i++)
+        Renderer::State().BindTexture(i, GL_TEXTURE_2D, m_TextureSlots[i]);
+
+    m_Shader->Bind();
+    m_VertexArray.Bind();
+    m_IndexBuffer->Bind();
+    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, m_QuadCount * 6, GL_UNSIGNED_INT, nullptr, m_BaseVertex));
+    Renderer::CountDraw(m_QuadCount * 6);
+}
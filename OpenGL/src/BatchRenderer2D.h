@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "StreamBuffer.h"
+#include "Shader.h"
+
+struct Vec2
+{
+	float x, y;
+};
+
+struct Vec4
+{
+	float x, y, z, w;
+};
+
+struct QuadVertex
+{
+	float Position[2];
+	float Color[4];
+	float TexCoord[2];
+	float TexIndex;
+};
+
+// Collects quads between Begin() and End() and draws them with as few draw
+// calls as possible. Vertices are written straight into a streamed vertex
+// buffer and every batch shares one pre-generated index buffer, so a batch is
+// broken only when it is full or runs out of texture slots.
+class BatchRenderer2D
+{
+public:
+	static constexpr unsigned int MaxQuads = 20000;  // per draw call
+	static constexpr unsigned int MaxVertices = MaxQuads * 4;
+	static constexpr unsigned int MaxIndices = MaxQuads * 6;
+	static constexpr unsigned int MaxTextureSlots = 16;
+private:
+	StreamBuffer m_VertexBuffer;
+	VertexArray m_VertexArray;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	std::shared_ptr<Shader> m_Shader;
+	unsigned int m_WhiteTexture;
+
+	QuadVertex* m_VertexBase;
+	unsigned int m_BaseVertex;
+	unsigned int m_QuadCount;
+	unsigned int m_BatchCapacity;  // quads reserved for the current batch
+	unsigned int m_DroppedQuads;   // this frame, past maxQuadsPerFrame
+
+	unsigned int m_TextureSlots[MaxTextureSlots];
+	unsigned int m_TextureSlotCount;
+public:
+	// A frame holding more quads than maxQuadsPerFrame drops the rest, the
+	// vertex buffer region of a frame isn't left before the frame ends.
+	BatchRenderer2D(unsigned int maxQuadsPerFrame = 100000);
+	~BatchRenderer2D();
+
+	void Begin();
+	void DrawQuad(const Vec2& position, const Vec2& size, const Vec4& color, unsigned int texture = 0);
+	void End();
+private:
+	void StartBatch();
+	void Flush();
+};
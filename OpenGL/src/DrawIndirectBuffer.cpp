@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <cstring>
+
+#include "DrawIndirectBuffer.h"
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+
+
+DrawIndirectBuffer::DrawIndirectBuffer(unsigned int maxDraws, unsigned int drawDataSize, unsigned int frameCount)
+    // every batch may start with alignment padding
+    : m_Commands(GL_DRAW_INDIRECT_BUFFER, (maxDraws + MaxBatches) * sizeof(DrawElementsIndirectCommand), frameCount),
+      m_DrawData(GL_SHADER_STORAGE_BUFFER, (drawDataSize > 0 ? maxDraws * drawDataSize : 4) + MaxBatches * 256, frameCount),
+      m_DrawDataSize(drawDataSize), m_CommandBase(nullptr), m_DrawDataBase(nullptr),
+      m_CommandOffset(0), m_DrawDataOffset(0), m_Capacity(0), m_DrawCount(0), m_IndexCount(0), m_InstanceCount(0)
+{
+    ASSERT(GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect);
+}
+
+bool DrawIndirectBuffer::Begin(unsigned int maxDraws)
+{
+    m_DrawCount = 0;
+    m_IndexCount = 0;
+    m_InstanceCount = 0;
+    m_Capacity = 0;
+
+    m_CommandBase = (DrawElementsIndirectCommand*)m_Commands.Reserve(maxDraws * sizeof(DrawElementsIndirectCommand),
+        sizeof(DrawElementsIndirectCommand), m_CommandOffset);
+    if (!m_CommandBase)
+        return false;
+
+    if (m_DrawDataSize > 0)
+    {
+        m_DrawDataBase = (unsigned char*)m_DrawData.Reserve(maxDraws * m_DrawDataSize, m_DrawDataOffset);
+        if (!m_DrawDataBase)
+            return false;
+    }
+
+    m_Capacity = maxDraws;
+    return true;
+}
+
+int DrawIndirectBuffer::AddDraw(const DrawElementsIndirectCommand& command, const void* drawData)
+{
+    const unsigned int index = m_DrawCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= m_Capacity)
+        return -1;
+
+    // the mapping is write-only, fill it without reading back
+    memcpy(m_CommandBase + index, &command, sizeof(command));
+    if (m_DrawDataSize > 0 && drawData)
+        memcpy(m_DrawDataBase + index * m_DrawDataSize, drawData, m_DrawDataSize);
+
+    m_IndexCount.fetch_add(command.Count * command.InstanceCount, std::memory_order_relaxed);
+    m_InstanceCount.fetch_add(command.InstanceCount, std::memory_order_relaxed);
+    return (int)index;
+}
+
+void DrawIndirectBuffer::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, unsigned int storageBinding)
+{
+    const unsigned int drawCount = GetDrawCount();
+    m_Commands.Commit(drawCount * sizeof(DrawElementsIndirectCommand));
+    if (m_DrawDataSize > 0)
+        m_DrawData.Commit(drawCount * m_DrawDataSize);
+    m_Capacity = 0;
+
+    if (drawCount == 0 || !shader.IsReady())
+        return;
+
+    shader.Bind();
+    shader.FlushUniforms();
+    va.Bind();
+    ib.Bind();
+    m_Commands.Bind();
+    if (m_DrawDataSize > 0)
+        m_DrawData.BindRange(storageBinding, m_DrawDataOffset, drawCount * m_DrawDataSize);
+
+    GLCall(glMultiDrawElementsIndirect(shader.GetPrimitiveType(), GL_UNSIGNED_INT, (const void*)(uintptr_t)m_CommandOffset,
+        drawCount, sizeof(DrawElementsIndirectCommand)));
+
+    // counted as one draw call, that's all the driver sees
+    Renderer::CountIndirectDraw(m_IndexCount.load(), m_InstanceCount.load());
+}
+
+void DrawIndirectBuffer::EndFrame()
+{
+    m_Commands.EndFrame();
+    m_DrawData.EndFrame();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+
+#include "StreamBuffer.h"
+#include "UniformBuffer.h"
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+
+// Layout glMultiDrawElementsIndirect reads from the GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand
+{
+	unsigned int Count;
+	unsigned int InstanceCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+	unsigned int BaseInstance;
+};
+
+// Collects indirect draw commands plus a block of per-draw data for each and
+// issues them all with one glMultiDrawElementsIndirect. The per-draw data is
+// bound as a shader storage buffer; the shader indexes it with gl_DrawID
+// (gl_DrawIDARB before GL 4.6), so the array stride in the std430 block has
+// to match drawDataSize.
+//
+// Commands are written straight into persistently mapped memory. AddDraw()
+// only takes a slot with an atomic increment, so several threads can record
+// into the same batch between Begin() and Submit(); Begin, Submit and
+// EndFrame belong to the thread that owns the context.
+class DrawIndirectBuffer
+{
+public:
+	static constexpr unsigned int MaxBatches = 16;  // Begin/Submit pairs per frame
+private:
+	StreamBuffer m_Commands;
+	UniformBuffer m_DrawData;
+	unsigned int m_DrawDataSize;
+
+	// current batch, set up by Begin()
+	DrawElementsIndirectCommand* m_CommandBase;
+	unsigned char* m_DrawDataBase;
+	unsigned int m_CommandOffset;
+	unsigned int m_DrawDataOffset;
+	unsigned int m_Capacity;
+	std::atomic<unsigned int> m_DrawCount;
+	std::atomic<unsigned int> m_IndexCount;     // summed over the instances
+	std::atomic<unsigned int> m_InstanceCount;
+public:
+	// maxDraws per frame, drawDataSize = bytes of per-draw data (0 for none)
+	DrawIndirectBuffer(unsigned int maxDraws, unsigned int drawDataSize, unsigned int frameCount = 3);
+
+	// Starts a batch of up to maxDraws draws that share a vertex array and program.
+	// Returns false if the frame has no room left.
+	bool Begin(unsigned int maxDraws);
+	// Returns the draw's index (its gl_DrawID), or -1 if the batch is full.
+	int AddDraw(const DrawElementsIndirectCommand& command, const void* drawData = nullptr);
+	// Draws the batch; the draw data goes to the given storage block binding.
+	void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, unsigned int storageBinding = 0);
+
+	void EndFrame();
+
+	inline unsigned int GetDrawCount() const { return m_DrawCount.load() < m_Capacity ? m_DrawCount.load() : m_Capacity; }
+};
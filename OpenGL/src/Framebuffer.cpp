@@ -0,0 +1,72 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "Renderer.h"
+
+
+Framebuffer::Framebuffer(unsigned int width, unsigned int height)
+    : m_RendererID(0), m_ColorAttachment(0), m_DepthAttachment(0), m_Width(width), m_Height(height)
+{
+    GLCall(glGenTextures(1, &m_ColorAttachment));
+    Renderer::State().BindTexture(0, GL_TEXTURE_2D, m_ColorAttachment);
+    GLCall(glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+
+    GLCall(glGenTextures(1, &m_DepthAttachment));
+    Renderer::State().BindTexture(0, GL_TEXTURE_2D, m_DepthAttachment);
+    GLCall(glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+
+    GLCall(glGenFramebuffers(1, &m_RendererID));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+    GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorAttachment, 0));
+    GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_DepthAttachment, 0));
+
+    GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer is incomplete (" << status << ")" << std::endl;
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+Framebuffer::~Framebuffer()
+{
+    GLCall(glDeleteFramebuffers(1, &m_RendererID));
+    Renderer::State().DeleteTexture(m_ColorAttachment);
+    Renderer::State().DeleteTexture(m_DepthAttachment);
+}
+
+void Framebuffer::Bind() const
+{
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+    GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::Unbind() const
+{
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+bool Framebuffer::WritePPM(const std::string& filepath) const
+{
+    std::vector<unsigned char> pixels(m_Width * m_Height * 4);
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+
+    std::ofstream stream(filepath, std::ios::binary);
+    if (!stream)
+        return false;
+
+    stream << "P6\n" << m_Width << " " << m_Height << "\n255\n";
+    // GL rows start at the bottom
+    for (unsigned int y = m_Height; y-- > 0;)
+    {
+        for (unsigned int x = 0; x < m_Width; x++)
+            stream.write((const char*)&pixels[(y * m_Width + x) * 4], 3);
+    }
+    return (bool)stream;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+// Offscreen render target with an RGBA8 color and a 32-bit float depth
+// texture. Headless runs render into one of these instead of a window.
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment;
+	unsigned int m_DepthAttachment;
+	unsigned int m_Width;
+	unsigned int m_Height;
+public:
+	Framebuffer(unsigned int width, unsigned int height);
+	~Framebuffer();
+
+	void Bind() const;  // also sets the viewport
+	void Unbind() const;
+
+	// writes the color attachment as a binary PPM image
+	bool WritePPM(const std::string& filepath) const;
+
+	inline unsigned int GetColorAttachment() const { return m_ColorAttachment; }
+	inline unsigned int GetDepthAttachment() const { return m_DepthAttachment; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+};
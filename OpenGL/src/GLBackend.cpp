@@ -0,0 +1,10 @@
+// the real functions are needed here, not the g_GLCore redirections
+#define GL_BACKEND_NO_REDIRECT
+#include "GLBackend.h"
+
+
+GLCoreFunctions g_GLCore = {
+#define GL_CORE_FUNCTION_ADDRESS(name) &::gl##name,
+    GL_CORE_FUNCTIONS(GL_CORE_FUNCTION_ADDRESS)
+#undef GL_CORE_FUNCTION_ADDRESS
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Every GL entry point the renderer uses goes through a function pointer that
+// can be swapped at runtime (see NullGL). Everything past GL 1.1 already is
+// one: GLEW resolves those into its __glew* pointers. The GL 1.1 functions are
+// exported directly by the GL library, so the ones we use are routed through
+// g_GLCore instead. Include this (or Renderer.h) instead of GL/glew.h.
+#define GL_CORE_FUNCTIONS(X) \
+	X(BindTexture)   \
+	X(Clear)         \
+	X(DeleteTextures)\
+	X(Disable)       \
+	X(DrawElements)  \
+	X(Enable)        \
+	X(Finish)        \
+	X(GenTextures)   \
+	X(GetError)      \
+	X(GetIntegerv)   \
+	X(GetString)     \
+	X(PixelStorei)   \
+	X(ReadPixels)    \
+	X(TexImage2D)    \
+	X(TexParameteri) \
+	X(Viewport)
+
+struct GLCoreFunctions
+{
+#define GL_CORE_FUNCTION_POINTER(name) decltype(&::gl##name) name;
+	GL_CORE_FUNCTIONS(GL_CORE_FUNCTION_POINTER)
+#undef GL_CORE_FUNCTION_POINTER
+};
+
+// initialized with the real GL 1.1 functions
+extern GLCoreFunctions g_GLCore;
+
+#ifndef GL_BACKEND_NO_REDIRECT
+	#define glBindTexture g_GLCore.BindTexture
+	#define glClear g_GLCore.Clear
+	#define glDeleteTextures g_GLCore.DeleteTextures
+	#define glDisable g_GLCore.Disable
+	#define glDrawElements g_GLCore.DrawElements
+	#define glEnable g_GLCore.Enable
+	#define glFinish g_GLCore.Finish
+	#define glGenTextures g_GLCore.GenTextures
+	#define glGetError g_GLCore.GetError
+	#define glGetIntegerv g_GLCore.GetIntegerv
+	#define glGetString g_GLCore.GetString
+	#define glPixelStorei g_GLCore.PixelStorei
+	#define glReadPixels g_GLCore.ReadPixels
+	#define glTexImage2D g_GLCore.TexImage2D
+	#define glTexParameteri g_GLCore.TexParameteri
+	#define glViewport g_GLCore.Viewport
+#endif
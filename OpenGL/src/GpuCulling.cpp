@@ -0,0 +1,234 @@
+#include <cmath>
+#include <cstring>
+
+#include "GpuCulling.h"
+#include "DrawIndirectBuffer.h"
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "ShaderLibrary.h"
+
+
+HiZPyramid::HiZPyramid(unsigned int width, unsigned int height)
+    : m_RendererID(0), m_Width(width), m_Height(height), m_LevelCount(1),
+      m_Shader(ShaderLibrary::Load("res/shaders/HiZ.shader"))
+{
+    // culling reads the pyramid from the first frame on
+    m_Shader->Wait();
+
+    while ((width | height) >> m_LevelCount)
+        m_LevelCount++;
+
+    GLCall(glGenTextures(1, &m_RendererID));
+    Renderer::State().BindTexture(0, GL_TEXTURE_2D, m_RendererID);
+    Renderer::State().ActiveTexture(0);
+    GLCall(glTexStorage2D(GL_TEXTURE_2D, m_LevelCount, GL_R32F, width, height));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+HiZPyramid::~HiZPyramid()
+{
+    Renderer::State().DeleteTexture(m_RendererID);
+}
+
+void HiZPyramid::Build(unsigned int depthTexture)
+{
+    if (!m_Shader->IsReady())
+        return;
+
+    Renderer::State().BindTexture(0, GL_TEXTURE_2D, depthTexture);
+    for (unsigned int level = 0; level < m_LevelCount; level++)
+    {
+        // Level 0 copies the depth, every other level reads only the one above it.
+        // That one is bound as a second image: limiting the sampler to it with
+        // BASE_LEVEL/MAX_LEVEL would make the destination level invalid.
+        m_Shader->SetUniform4f("u_Params", level == 0 ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f);
+        if (level > 0)
+        {
+            GLCall(glBindImageTexture(1, m_RendererID, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F));
+        }
+        GLCall(glBindImageTexture(0, m_RendererID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F));
+
+        unsigned int width = m_Width >> level ? m_Width >> level : 1;
+        unsigned int height = m_Height >> level ? m_Height >> level : 1;
+        const unsigned int* groupSize = m_Shader->GetWorkGroupSize();
+        Renderer::Dispatch(*m_Shader, (width + groupSize[0] - 1) / groupSize[0], (height + groupSize[1] - 1) / groupSize[1]);
+        Renderer::Barrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+}
+
+
+GpuCulling::GpuCulling(unsigned int maxObjects)
+    : m_MaxObjects(maxObjects), m_ObjectCount(0), m_ObjectBuffer(0), m_CommandBuffer(0), m_CountBuffer(0),
+      m_Shader(ShaderLibrary::Load("res/shaders/Cull.shader")), m_Params(GL_UNIFORM_BUFFER, 256), m_ParamsLayout(BlockLayoutRule::Std140),
+      m_HiZ(nullptr), m_HiZViewProj()
+{
+    ASSERT(GLEW_VERSION_4_3 || GLEW_ARB_compute_shader);
+    // a skipped pass leaves the draw commands empty, nothing would be drawn
+    m_Shader->Wait();
+
+    // same order as CullParams in Cull.shader
+    m_ParamsLayout.Push(BlockMemberType::Vec4, 6);  // u_Planes
+    m_ParamsLayout.Push(BlockMemberType::Mat4);     // u_HiZViewProj
+    m_ParamsLayout.Push(BlockMemberType::Vec4);     // u_HiZSize
+    m_ParamsLayout.Push(BlockMemberType::Int);      // u_ObjectCount
+    m_ParamsLayout.Push(BlockMemberType::Int);      // u_UseHiZ
+
+    GLCall(glGenBuffers(1, &m_ObjectBuffer));
+    Renderer::State().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_ObjectBuffer);
+    GLCall(glBufferStorage(GL_SHADER_STORAGE_BUFFER, maxObjects * sizeof(CullObject), nullptr, GL_DYNAMIC_STORAGE_BIT));
+
+    // only ever written by the GPU
+    GLCall(glGenBuffers(1, &m_CommandBuffer));
+    Renderer::State().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_CommandBuffer);
+    GLCall(glBufferStorage(GL_SHADER_STORAGE_BUFFER, maxObjects * sizeof(DrawElementsIndirectCommand), nullptr, 0));
+
+    GLCall(glGenBuffers(1, &m_CountBuffer));
+    Renderer::State().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_CountBuffer);
+    GLCall(glBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int), nullptr, 0));
+}
+
+GpuCulling::~GpuCulling()
+{
+    Renderer::State().DeleteBuffer(m_ObjectBuffer);
+    Renderer::State().DeleteBuffer(m_CommandBuffer);
+    Renderer::State().DeleteBuffer(m_CountBuffer);
+}
+
+void GpuCulling::SetObjects(const CullObject* objects, unsigned int count)
+{
+    ASSERT(count <= m_MaxObjects);
+    m_ObjectCount = count;
+    if (count == 0)
+        return;
+
+    Renderer::State().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_ObjectBuffer);
+    GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(CullObject), objects));
+    Renderer::CountUpload(count * sizeof(CullObject));
+}
+
+void GpuCulling::SetHiZ(const HiZPyramid* hiz, const float viewProj[16])
+{
+    m_HiZ = hiz;
+    if (hiz)
+        memcpy(m_HiZViewProj, viewProj, sizeof(m_HiZViewProj));
+}
+
+void GpuCulling::Cull(const float viewProj[16])
+{
+    // the count has to start from zero even if nothing is dispatched
+    Renderer::State().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_CountBuffer);
+    GLCall(glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr));
+    if (!HasDrawCount())
+    {
+        Renderer::State().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_CommandBuffer);
+        GLCall(glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr));
+    }
+
+    if (m_ObjectCount == 0 || !m_Shader->IsReady())
+        return;
+
+    unsigned int offset;
+    unsigned char* params = (unsigned char*)m_Params.Allocate(m_ParamsLayout.GetSize(), offset);
+    if (!params)
+        return;
+
+    const std::vector<unsigned int>& offsets = m_ParamsLayout.GetOffsets();
+    float planes[6][4];
+    ExtractFrustumPlanes(viewProj, planes);
+    memcpy(params + offsets[0], planes, sizeof(planes));
+    memcpy(params + offsets[1], m_HiZViewProj, sizeof(m_HiZViewProj));
+    const float hizSize[4] = {
+        m_HiZ ? (float)m_HiZ->GetWidth() : 0.0f, m_HiZ ? (float)m_HiZ->GetHeight() : 0.0f,
+        m_HiZ ? (float)m_HiZ->GetLevelCount() : 0.0f, 0.0f
+    };
+    memcpy(params + offsets[2], hizSize, sizeof(hizSize));
+    const unsigned int objectCount = m_ObjectCount;
+    const unsigned int useHiZ = m_HiZ ? 1 : 0;
+    memcpy(params + offsets[3], &objectCount, sizeof(objectCount));
+    memcpy(params + offsets[4], &useHiZ, sizeof(useHiZ));
+    m_Params.BindRange(0, offset, m_ParamsLayout.GetSize());
+
+    Renderer::State().BindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_ObjectBuffer, 0, m_MaxObjects * sizeof(CullObject));
+    Renderer::State().BindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, m_CommandBuffer, 0, m_MaxObjects * sizeof(DrawElementsIndirectCommand));
+    Renderer::State().BindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, m_CountBuffer, 0, sizeof(unsigned int));
+    if (m_HiZ)
+        Renderer::State().BindTexture(0, GL_TEXTURE_2D, m_HiZ->GetRendererID());
+
+    const unsigned int groupSize = m_Shader->GetWorkGroupSize()[0];
+    Renderer::Dispatch(*m_Shader, (m_ObjectCount + groupSize - 1) / groupSize);
+    // the draw reads the commands and the count written above
+    Renderer::Barrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_Params.EndFrame();
+}
+
+void GpuCulling::Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader)
+{
+    if (m_ObjectCount == 0 || !shader.IsReady())
+        return;
+
+    shader.Bind();
+    shader.FlushUniforms();
+    va.Bind();
+    ib.Bind();
+    Renderer::State().BindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_ObjectBuffer, 0, m_MaxObjects * sizeof(CullObject));
+    Renderer::State().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+
+    const GLsizei stride = sizeof(DrawElementsIndirectCommand);
+    if (GLEW_VERSION_4_6)
+    {
+        Renderer::State().BindBuffer(GL_PARAMETER_BUFFER, m_CountBuffer);
+        GLCall(glMultiDrawElementsIndirectCount(shader.GetPrimitiveType(), GL_UNSIGNED_INT, nullptr, 0, m_ObjectCount, stride));
+    }
+    else if (GLEW_ARB_indirect_parameters)
+    {
+        Renderer::State().BindBuffer(GL_PARAMETER_BUFFER_ARB, m_CountBuffer);
+        GLCall(glMultiDrawElementsIndirectCountARB(shader.GetPrimitiveType(), GL_UNSIGNED_INT, nullptr, 0, m_ObjectCount, stride));
+    }
+    else
+    {
+        GLCall(glMultiDrawElementsIndirect(shader.GetPrimitiveType(), GL_UNSIGNED_INT, nullptr, m_ObjectCount, stride));
+    }
+    // the index count is only known to the GPU
+    Renderer::CountDraw(0);
+}
+
+unsigned int GpuCulling::ReadDrawCount() const
+{
+    unsigned int count = 0;
+    Renderer::BufferReadBarrier();
+    Renderer::State().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_CountBuffer);
+    GLCall(glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(count), &count));
+    return count;
+}
+
+void GpuCulling::ExtractFrustumPlanes(const float m[16], float planes[6][4])
+{
+    // Gribb & Hartmann: row 3 +- rows 0..2 of the (column major) matrix
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            planes[i * 2 + 0][j] = m[j * 4 + 3] + m[j * 4 + i];
+            planes[i * 2 + 1][j] = m[j * 4 + 3] - m[j * 4 + i];
+        }
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        float length = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+        if (length > 0.0f)
+        {
+            for (int j = 0; j < 4; j++)
+                planes[i][j] /= length;
+        }
+    }
+}
+
+bool GpuCulling::HasDrawCount()
+{
+    return GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+
+#include "Shader.h"
+#include "UniformBuffer.h"
+
+class VertexArray;
+class IndexBuffer;
+
+// Object as the culling pass reads it (std430, 32 bytes).
+struct CullObject
+{
+	float Center[3];
+	float Radius;       // bounding sphere
+	unsigned int IndexCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+	unsigned int Padding;
+};
+
+// Max depth pyramid built from a depth texture, for occlusion tests against
+// the previous frame.
+class HiZPyramid
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_LevelCount;
+	std::shared_ptr<Shader> m_Shader;
+public:
+	HiZPyramid(unsigned int width, unsigned int height);
+	~HiZPyramid();
+
+	HiZPyramid(const HiZPyramid&) = delete;
+	HiZPyramid& operator=(const HiZPyramid&) = delete;
+
+	// depthTexture must be width x height
+	void Build(unsigned int depthTexture);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetLevelCount() const { return m_LevelCount; }
+};
+
+// Culls bounding spheres against the view frustum (and optionally a HiZPyramid)
+// in a compute shader. Visible objects are appended as compacted
+// DrawElementsIndirectCommands with an atomic counter, and Draw() issues them
+// with glMultiDrawElementsIndirectCount, so the CPU never sees the result.
+// Without ARB_indirect_parameters the command buffer is cleared first and all
+// maxObjects commands are drawn, the unused ones having no instances.
+//
+// Each command's BaseInstance is the object's index; the draw shader finds
+// its object through gl_BaseInstance in the object buffer, which Draw()
+// binds to storage binding 0.
+class GpuCulling
+{
+private:
+	unsigned int m_MaxObjects;
+	unsigned int m_ObjectCount;
+	unsigned int m_ObjectBuffer;
+	unsigned int m_CommandBuffer;
+	unsigned int m_CountBuffer;
+	std::shared_ptr<Shader> m_Shader;
+	UniformBuffer m_Params;
+	BlockLayout m_ParamsLayout;
+
+	const HiZPyramid* m_HiZ;
+	float m_HiZViewProj[16];
+public:
+	GpuCulling(unsigned int maxObjects);
+	~GpuCulling();
+
+	GpuCulling(const GpuCulling&) = delete;
+	GpuCulling& operator=(const GpuCulling&) = delete;
+
+	void SetObjects(const CullObject* objects, unsigned int count);
+	// viewProj is what the pyramid's depth was rendered with; nullptr hiz turns the test off
+	void SetHiZ(const HiZPyramid* hiz, const float viewProj[16]);
+
+	// viewProj is column major, like glUniformMatrix4fv without transpose
+	void Cull(const float viewProj[16]);
+	void Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader);
+
+	// Reads the visible count back, which waits for the GPU. For debugging.
+	unsigned int ReadDrawCount() const;
+	inline unsigned int GetObjectCount() const { return m_ObjectCount; }
+	inline unsigned int GetObjectBuffer() const { return m_ObjectBuffer; }
+
+	// Normalized planes (xyz = normal, w = distance), pointing inside
+	static void ExtractFrustumPlanes(const float viewProj[16], float planes[6][4]);
+private:
+	static bool HasDrawCount();
+};
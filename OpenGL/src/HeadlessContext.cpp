@@ -0,0 +1,158 @@
+#include <iostream>
+#include <cstring>
+
+#include "HeadlessContext.h"
+
+#ifdef __linux__
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+
+HeadlessContext::HeadlessContext()
+    : m_Display(nullptr), m_Context(nullptr), m_Surface(nullptr)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    Destroy();
+}
+
+#ifdef __linux__
+
+static bool HasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+    const size_t length = strlen(name);
+    for (const char* start = extensions; (start = strstr(start, name)); start += length)
+    {
+        if ((start == extensions || start[-1] == ' ') && (start[length] == ' ' || start[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+bool HeadlessContext::Create(int major, int minor, bool debug)
+{
+    // client extensions exist without a display
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    if (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint eglMajor, eglMinor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &eglMajor, &eglMinor))
+    {
+        std::cout << "EGL: no display available" << std::endl;
+        return false;
+    }
+    m_Display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "EGL: desktop OpenGL not supported" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const bool surfaceless = HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cout << "EGL: no suitable config" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    // llvmpipe for example tops out at 4.5. Nothing older is tried: the
+    // shaders are #version 450 and StreamBuffer needs GL 4.4 buffer storage.
+    const int versions[][2] = { { 4, 6 }, { 4, 5 } };
+    EGLContext context = EGL_NO_CONTEXT;
+    for (const auto& version : versions)
+    {
+        if (version[0] > major || (version[0] == major && version[1] > minor))
+            continue;
+
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0],
+            EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context != EGL_NO_CONTEXT)
+            break;
+    }
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cout << "EGL: can't create an OpenGL " << major << "." << minor << " core context, the renderer needs 4.5 or newer" << std::endl;
+        Destroy();
+        return false;
+    }
+    m_Context = context;
+
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!surfaceless)
+    {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        m_Surface = surface;
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        std::cout << "EGL: can't make the context current" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (!m_Display)
+        return;
+
+    eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_Surface)
+        eglDestroySurface(m_Display, m_Surface);
+    if (m_Context)
+        eglDestroyContext(m_Display, m_Context);
+    eglTerminate(m_Display);
+
+    m_Display = nullptr;
+    m_Context = nullptr;
+    m_Surface = nullptr;
+}
+
+#else
+
+bool HeadlessContext::Create(int major, int minor, bool debug)
+{
+    std::cout << "Headless rendering is only supported on Linux (EGL)" << std::endl;
+    return false;
+}
+
+void HeadlessContext::Destroy()
+{
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+// OpenGL context without a window or display, created through EGL
+// (surfaceless where Mesa supports it, otherwise a 1x1 pbuffer). Works with
+// Mesa's llvmpipe, so everything can run on machines with no GPU. Render
+// into a Framebuffer, there is no default framebuffer to draw to.
+// Linux only; elsewhere Create() fails.
+class HeadlessContext
+{
+private:
+	void* m_Display;
+	void* m_Context;
+	void* m_Surface;
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	// Creates a core profile context of the given version, or 4.5 if the
+	// driver doesn't offer it, and makes it current. Fails below 4.5, which
+	// the renderer needs.
+	bool Create(int major, int minor, bool debug = false);
+	void Destroy();
+};
@@ -1,29 +1,42 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "Profiler.h"
 
 
 IndexBuffer::IndexBuffer(const void* data, unsigned int count)
     : m_Count(count)
 {
+    PROFILE_SCOPE("IndexBuffer::IndexBuffer");
+
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-    GLCall(glGenBuffers(1, &m_RendererID));  // &iBuffer = generoidun bufferin ID
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));  // binding = valitaan
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+    if (Renderer::HasDirectStateAccess())
+    {
+        // binding GL_ELEMENT_ARRAY_BUFFER would also attach it to the bound vertex array
+        GLCall(glCreateBuffers(1, &m_RendererID));
+        GLCall(glNamedBufferStorage(m_RendererID, count * sizeof(unsigned int), data, 0));
+    }
+    else
+    {
+        GLCall(glGenBuffers(1, &m_RendererID));  // &iBuffer = generoidun bufferin ID
+        Renderer::State().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);  // binding = valitaan
+        GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+    }
+    Renderer::CountUpload(count * sizeof(unsigned int));
 
 }
 
 IndexBuffer::~IndexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID))
+    Renderer::State().DeleteBuffer(m_RendererID);
 }
 
 void IndexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));  // binding = valitaan
+    Renderer::State().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);  // binding = valitaan
 }
 
 void IndexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));  // binding = valitaan
+    Renderer::State().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);  // binding = valitaan
 }
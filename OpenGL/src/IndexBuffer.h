@@ -12,5 +12,6 @@ public:
 	void Bind() const;
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 	inline unsigned int GetCount() const { return m_Count; }
 };
\ No newline at end of file
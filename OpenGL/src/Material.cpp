@@ -0,0 +1,36 @@
+#include "Material.h"
+
+
+static unsigned int s_NextMaterialID = 1;
+
+Material::Material()
+    : m_ID(s_NextMaterialID++)
+{
+}
+
+void Material::SetUniform4f(const UniformHandle& uniform, float v0, float v1, float v2, float v3)
+{
+    for (auto& value : m_Uniforms4f)
+    {
+        if (value.Uniform.GetSlot() == uniform.GetSlot())
+        {
+            value.Values[0] = v0;
+            value.Values[1] = v1;
+            value.Values[2] = v2;
+            value.Values[3] = v3;
+            return;
+        }
+    }
+    m_Uniforms4f.push_back({ uniform, { v0, v1, v2, v3 } });
+}
+
+void Material::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+{
+    SetUniform4f(UniformHandle(name), v0, v1, v2, v3);
+}
+
+void Material::Apply(Shader& shader) const
+{
+    for (const auto& value : m_Uniforms4f)
+        shader.SetUniform4f(value.Uniform, value.Values[0], value.Values[1], value.Values[2], value.Values[3]);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+struct MaterialUniform4f
+{
+	UniformHandle Uniform;
+	float Values[4];
+};
+
+// Set of uniform values applied together before a draw. The id orders draws
+// with the same program and vertex array in the renderer queue.
+class Material
+{
+private:
+	unsigned int m_ID;
+	std::vector<MaterialUniform4f> m_Uniforms4f;
+public:
+	Material();
+
+	void SetUniform4f(const UniformHandle& uniform, float v0, float v1, float v2, float v3);
+	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+	void Apply(Shader& shader) const;
+
+	inline unsigned int GetID() const { return m_ID; }
+};
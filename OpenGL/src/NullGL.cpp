@@ -0,0 +1,696 @@
+#include "NullGL.h"
+#include "GLBackend.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+
+bool NullGL::s_Installed = false;
+bool NullGL::s_Recording = false;
+unsigned int NullGL::s_CallCount = 0;
+std::vector<const char*> NullGL::s_Calls;
+NullGLConfig NullGL::s_Config;
+
+// GLEW pointers replaced by Install(), named without the gl prefix
+#define NULL_GL_FUNCTIONS(X) \
+    X(ActiveTexture) X(AttachShader) X(BindBuffer) X(BindBufferRange) X(BindFramebuffer) \
+    X(BindVertexArray) X(BufferData) X(BufferStorage) X(CheckFramebufferStatus) X(ClientWaitSync) \
+    X(CompileShader) X(CreateProgram) X(CreateShader) X(DebugMessageCallback) X(DebugMessageControl) \
+    X(DeleteBuffers) X(DeleteFramebuffers) X(DeleteProgram) X(DeleteQueries) X(DeleteShader) \
+    X(DeleteSync) X(DeleteVertexArrays) X(DetachShader) X(DrawElementsBaseVertex) X(DrawElementsInstanced) \
+    X(EnableVertexAttribArray) X(FenceSync) X(FramebufferTexture2D) X(GenBuffers) X(GenFramebuffers) \
+    X(GenQueries) X(GenVertexArrays) X(GetInteger64v) X(GetProgramBinary) X(GetProgramInfoLog) \
+    X(GetProgramInterfaceiv) X(GetProgramResourceIndex) X(GetProgramResourceName) X(GetProgramResourceiv) X(GetProgramiv) \
+    X(GetQueryObjecti64v) X(GetQueryObjectiv) X(GetShaderInfoLog) X(GetShaderiv) X(GetUniformLocation) \
+    X(LinkProgram) X(MapBufferRange) X(MaxShaderCompilerThreadsARB) X(MaxShaderCompilerThreadsKHR) X(MultiDrawElementsIndirect) X(ProgramBinary) \
+    X(ProgramParameteri) X(ProgramUniform4fv) X(QueryCounter) X(ShaderSource) X(ShaderStorageBlockBinding) \
+    X(TexStorage2D) X(UniformBlockBinding) X(UseProgram) X(ValidateProgram) X(VertexAttribDivisor) \
+    X(VertexAttribPointer) X(BindImageTexture) X(BufferSubData) X(ClearBufferData) X(DispatchCompute) \
+    X(GetBufferSubData) X(MemoryBarrier) X(MultiDrawElementsIndirectCount) X(MultiDrawElementsIndirectCountARB) \
+    X(DispatchComputeIndirect) X(BindProgramPipeline) X(DeleteProgramPipelines) X(GenProgramPipelines) \
+    X(GetProgramPipelineInfoLog) X(GetProgramPipelineiv) X(UseProgramStages) X(ValidateProgramPipeline) \
+    X(CreateBuffers) X(CreateVertexArrays) X(EnableVertexArrayAttrib) X(MapNamedBufferRange) X(NamedBufferStorage) \
+    X(VertexArrayAttribBinding) X(VertexArrayAttribFormat) X(VertexArrayBindingDivisor) X(VertexArrayElementBuffer) \
+    X(VertexArrayVertexBuffer)
+
+// GLEW_VERSION_* flags reported as supported
+#define NULL_GL_VERSIONS(X) \
+    X(1_1) X(1_2) X(1_3) X(1_4) X(1_5) X(2_0) X(2_1) X(3_0) X(3_1) X(3_2) X(3_3) \
+    X(4_0) X(4_1) X(4_2) X(4_3) X(4_4) X(4_5) X(4_6)
+
+#define NULL_GL_SAVED_FUNCTION(name) static decltype(__glew##name) s_Driver##name;
+NULL_GL_FUNCTIONS(NULL_GL_SAVED_FUNCTION)
+#undef NULL_GL_SAVED_FUNCTION
+
+#define NULL_GL_SAVED_VERSION(version) static GLboolean s_DriverVersion##version;
+NULL_GL_VERSIONS(NULL_GL_SAVED_VERSION)
+#undef NULL_GL_SAVED_VERSION
+
+static GLCoreFunctions s_DriverCore;
+
+
+// Fake object state. Names are shared between all object types.
+static GLuint s_NextName = 1;
+static std::unordered_map<GLenum, GLuint> s_BoundBuffers;
+static std::unordered_map<GLuint, std::vector<unsigned char>> s_BufferStorage;
+static std::unordered_map<GLuint, GLenum> s_ShaderTypes;
+static std::unordered_map<std::string, GLint> s_UniformLocations;
+
+struct NullVertexBinding
+{
+    GLuint Buffer = 0;
+    GLsizei Stride = 0;
+    GLuint Divisor = 0;
+};
+
+struct NullVertexArray
+{
+    std::unordered_map<GLuint, NullGLVertexAttrib> Attribs;
+    std::unordered_map<GLuint, NullVertexBinding> Bindings;
+};
+
+static GLuint s_BoundVertexArray = 0;
+static std::unordered_map<GLuint, NullVertexArray> s_VertexArrays;
+
+static void GenNames(GLsizei n, GLuint* names)
+{
+    for (GLsizei i = 0; i < n; i++)
+        names[i] = s_NextName++;
+}
+
+static void WriteInfoLog(GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    const std::string& log = NullGL::Config().InfoLog;
+    GLsizei count = bufSize > 0 ? std::min((GLsizei)log.size(), bufSize - 1) : 0;
+    if (bufSize > 0)
+    {
+        memcpy(infoLog, log.data(), count);
+        infoLog[count] = '\0';
+    }
+    if (length)
+        *length = count;
+}
+
+// index into NullGLConfig::Uniforms, -1 for other interfaces and past the end
+static GLint FindConfigUniform(GLenum programInterface, GLuint index)
+{
+    if (programInterface != GL_UNIFORM || index >= NullGL::Config().Uniforms.size())
+        return -1;
+    return (GLint)index;
+}
+
+static void AllocateBuffer(GLenum target, GLsizeiptr size)
+{
+    auto it = s_BoundBuffers.find(target);
+    if (it != s_BoundBuffers.end() && it->second != 0)
+        s_BufferStorage[it->second].assign((size_t)size, 0);
+}
+
+
+// GL 1.1
+
+static void GLAPIENTRY NullBindTexture(GLenum, GLuint) { NullGL::Record("glBindTexture"); }
+static void GLAPIENTRY NullClear(GLbitfield) { NullGL::Record("glClear"); }
+static void GLAPIENTRY NullDeleteTextures(GLsizei, const GLuint*) { NullGL::Record("glDeleteTextures"); }
+static void GLAPIENTRY NullDisable(GLenum) { NullGL::Record("glDisable"); }
+static void GLAPIENTRY NullDrawElements(GLenum, GLsizei, GLenum, const void*) { NullGL::Record("glDrawElements"); }
+static void GLAPIENTRY NullEnable(GLenum) { NullGL::Record("glEnable"); }
+static void GLAPIENTRY NullFinish() { NullGL::Record("glFinish"); }
+
+static void GLAPIENTRY NullGenTextures(GLsizei n, GLuint* textures)
+{
+    NullGL::Record("glGenTextures");
+    GenNames(n, textures);
+}
+
+static GLenum GLAPIENTRY NullGetError()
+{
+    NullGL::Record("glGetError");
+    return GL_NO_ERROR;
+}
+
+static void GLAPIENTRY NullGetIntegerv(GLenum pname, GLint* params)
+{
+    NullGL::Record("glGetIntegerv");
+    switch (pname)
+    {
+        case GL_MAJOR_VERSION: *params = 4; break;
+        case GL_MINOR_VERSION: *params = 6; break;
+        case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *params = 256; break;
+        case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT: *params = 16; break;
+        case GL_MAX_TEXTURE_IMAGE_UNITS: *params = 32; break;
+        default: *params = 0; break;
+    }
+}
+
+static const GLubyte* GLAPIENTRY NullGetString(GLenum name)
+{
+    NullGL::Record("glGetString");
+    switch (name)
+    {
+        case GL_VERSION: return (const GLubyte*)NullGL::Config().Version;
+        case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte*)"4.60";
+        default: return (const GLubyte*)"Null";
+    }
+}
+
+static void GLAPIENTRY NullPixelStorei(GLenum, GLint) { NullGL::Record("glPixelStorei"); }
+static void GLAPIENTRY NullReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*) { NullGL::Record("glReadPixels"); }
+static void GLAPIENTRY NullTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) { NullGL::Record("glTexImage2D"); }
+static void GLAPIENTRY NullTexParameteri(GLenum, GLenum, GLint) { NullGL::Record("glTexParameteri"); }
+static void GLAPIENTRY NullViewport(GLint, GLint, GLsizei, GLsizei) { NullGL::Record("glViewport"); }
+
+
+// buffers and vertex arrays
+
+static void GLAPIENTRY NullActiveTexture(GLenum) { NullGL::Record("glActiveTexture"); }
+
+static void GLAPIENTRY NullBindBuffer(GLenum target, GLuint buffer)
+{
+    NullGL::Record("glBindBuffer");
+    s_BoundBuffers[target] = buffer;
+}
+
+static void GLAPIENTRY NullBindBufferRange(GLenum target, GLuint, GLuint buffer, GLintptr, GLsizeiptr)
+{
+    NullGL::Record("glBindBufferRange");
+    s_BoundBuffers[target] = buffer;  // also binds the generic binding point
+}
+
+static void GLAPIENTRY NullBindVertexArray(GLuint array)
+{
+    NullGL::Record("glBindVertexArray");
+    s_BoundVertexArray = array;
+}
+
+// contents are only kept for buffers that can be mapped
+static void GLAPIENTRY NullBufferData(GLenum, GLsizeiptr, const void*, GLenum) { NullGL::Record("glBufferData"); }
+
+static void GLAPIENTRY NullBufferStorage(GLenum target, GLsizeiptr size, const void*, GLbitfield)
+{
+    NullGL::Record("glBufferStorage");
+    AllocateBuffer(target, size);
+}
+
+static void GLAPIENTRY NullBufferSubData(GLenum, GLintptr, GLsizeiptr, const void*) { NullGL::Record("glBufferSubData"); }
+static void GLAPIENTRY NullClearBufferData(GLenum, GLenum, GLenum, GLenum, const void*) { NullGL::Record("glClearBufferData"); }
+
+static void GLAPIENTRY NullDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    NullGL::Record("glDeleteBuffers");
+    for (GLsizei i = 0; i < n; i++)
+        s_BufferStorage.erase(buffers[i]);
+}
+
+static void GLAPIENTRY NullDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    NullGL::Record("glDeleteVertexArrays");
+    for (GLsizei i = 0; i < n; i++)
+    {
+        s_VertexArrays.erase(arrays[i]);
+        if (arrays[i] == s_BoundVertexArray)
+            s_BoundVertexArray = 0;
+    }
+}
+static void GLAPIENTRY NullDrawElementsBaseVertex(GLenum, GLsizei, GLenum, void*, GLint) { NullGL::Record("glDrawElementsBaseVertex"); }
+static void GLAPIENTRY NullDrawElementsInstanced(GLenum, GLsizei, GLenum, const void*, GLsizei) { NullGL::Record("glDrawElementsInstanced"); }
+static void GLAPIENTRY NullEnableVertexAttribArray(GLuint index)
+{
+    NullGL::Record("glEnableVertexAttribArray");
+    s_VertexArrays[s_BoundVertexArray].Attribs[index].Enabled = true;
+}
+
+static void GLAPIENTRY NullGenBuffers(GLsizei n, GLuint* buffers)
+{
+    NullGL::Record("glGenBuffers");
+    GenNames(n, buffers);
+}
+
+static void GLAPIENTRY NullGenVertexArrays(GLsizei n, GLuint* arrays)
+{
+    NullGL::Record("glGenVertexArrays");
+    GenNames(n, arrays);
+}
+
+static void* GLAPIENTRY NullMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr, GLbitfield)
+{
+    NullGL::Record("glMapBufferRange");
+    auto it = s_BufferStorage.find(s_BoundBuffers[target]);
+    if (it == s_BufferStorage.end())
+        return nullptr;
+    return it->second.data() + offset;
+}
+
+static void GLAPIENTRY NullGetBufferSubData(GLenum, GLintptr, GLsizeiptr size, void* data)
+{
+    NullGL::Record("glGetBufferSubData");
+    memset(data, 0, (size_t)size);
+}
+
+static void GLAPIENTRY NullMultiDrawElementsIndirect(GLenum, GLenum, const void*, GLsizei, GLsizei) { NullGL::Record("glMultiDrawElementsIndirect"); }
+static void GLAPIENTRY NullMultiDrawElementsIndirectCount(GLenum, GLenum, const GLvoid*, GLintptr, GLsizei, GLsizei) { NullGL::Record("glMultiDrawElementsIndirectCount"); }
+static void GLAPIENTRY NullMultiDrawElementsIndirectCountARB(GLenum, GLenum, const void*, GLintptr, GLsizei, GLsizei) { NullGL::Record("glMultiDrawElementsIndirectCountARB"); }
+static void GLAPIENTRY NullVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    NullGL::Record("glVertexAttribDivisor");
+    NullVertexArray& vertexArray = s_VertexArrays[s_BoundVertexArray];
+    vertexArray.Attribs[index].Binding = index;
+    vertexArray.Bindings[index].Divisor = divisor;
+}
+
+static void GLAPIENTRY NullVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+    NullGL::Record("glVertexAttribPointer");
+    NullVertexArray& vertexArray = s_VertexArrays[s_BoundVertexArray];
+    NullGLVertexAttrib& attrib = vertexArray.Attribs[index];
+    attrib.Size = size;
+    attrib.Type = type;
+    attrib.Normalized = normalized == GL_TRUE;
+    attrib.Offset = (unsigned int)(uintptr_t)pointer;
+    attrib.Binding = index;
+    NullVertexBinding& binding = vertexArray.Bindings[index];
+    binding.Buffer = s_BoundBuffers[GL_ARRAY_BUFFER];
+    binding.Stride = stride;
+}
+
+
+// textures and framebuffers
+
+static void GLAPIENTRY NullBindFramebuffer(GLenum, GLuint) { NullGL::Record("glBindFramebuffer"); }
+
+static GLenum GLAPIENTRY NullCheckFramebufferStatus(GLenum)
+{
+    NullGL::Record("glCheckFramebufferStatus");
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static void GLAPIENTRY NullDeleteFramebuffers(GLsizei, const GLuint*) { NullGL::Record("glDeleteFramebuffers"); }
+static void GLAPIENTRY NullFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) { NullGL::Record("glFramebufferTexture2D"); }
+
+static void GLAPIENTRY NullGenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    NullGL::Record("glGenFramebuffers");
+    GenNames(n, framebuffers);
+}
+
+static void GLAPIENTRY NullBindImageTexture(GLuint, GLuint, GLint, GLboolean, GLint, GLenum, GLenum) { NullGL::Record("glBindImageTexture"); }
+static void GLAPIENTRY NullTexStorage2D(GLenum, GLsizei, GLenum, GLsizei, GLsizei) { NullGL::Record("glTexStorage2D"); }
+
+
+// shaders and programs
+
+static void GLAPIENTRY NullAttachShader(GLuint, GLuint) { NullGL::Record("glAttachShader"); }
+static void GLAPIENTRY NullCompileShader(GLuint) { NullGL::Record("glCompileShader"); }
+
+static GLuint GLAPIENTRY NullCreateProgram()
+{
+    NullGL::Record("glCreateProgram");
+    return s_NextName++;
+}
+
+static GLuint GLAPIENTRY NullCreateShader(GLenum type)
+{
+    NullGL::Record("glCreateShader");
+    s_ShaderTypes[s_NextName] = type;
+    return s_NextName++;
+}
+
+static void GLAPIENTRY NullDeleteProgram(GLuint) { NullGL::Record("glDeleteProgram"); }
+
+static void GLAPIENTRY NullDeleteShader(GLuint shader)
+{
+    NullGL::Record("glDeleteShader");
+    s_ShaderTypes.erase(shader);
+}
+
+static void GLAPIENTRY NullDetachShader(GLuint, GLuint) { NullGL::Record("glDetachShader"); }
+
+static void GLAPIENTRY NullGetProgramBinary(GLuint, GLsizei, GLsizei* length, GLenum*, void*)
+{
+    NullGL::Record("glGetProgramBinary");
+    if (length)
+        *length = 0;
+}
+
+static void GLAPIENTRY NullGetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    NullGL::Record("glGetProgramInfoLog");
+    WriteInfoLog(bufSize, length, infoLog);
+}
+
+static void GLAPIENTRY NullGetProgramInterfaceiv(GLuint, GLenum programInterface, GLenum pname, GLint* params)
+{
+    // only the configured uniforms are active, others are looked up with glGetUniformLocation
+    NullGL::Record("glGetProgramInterfaceiv");
+    *params = 0;
+    if (programInterface != GL_UNIFORM)
+        return;
+
+    const std::vector<std::string>& uniforms = NullGL::Config().Uniforms;
+    if (pname == GL_ACTIVE_RESOURCES)
+        *params = (GLint)uniforms.size();
+    else if (pname == GL_MAX_NAME_LENGTH)
+    {
+        for (const std::string& uniform : uniforms)
+            *params = std::max(*params, (GLint)uniform.size() + 1);
+    }
+}
+
+static GLuint GLAPIENTRY NullGetProgramResourceIndex(GLuint, GLenum programInterface, const GLchar* name)
+{
+    NullGL::Record("glGetProgramResourceIndex");
+    const std::vector<std::string>& uniforms = NullGL::Config().Uniforms;
+    auto it = std::find(uniforms.begin(), uniforms.end(), name);
+    if (programInterface != GL_UNIFORM || it == uniforms.end())
+        return GL_INVALID_INDEX;
+    return (GLuint)(it - uniforms.begin());
+}
+
+static void GLAPIENTRY NullGetProgramResourceName(GLuint, GLenum programInterface, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name)
+{
+    NullGL::Record("glGetProgramResourceName");
+    GLint uniform = FindConfigUniform(programInterface, index);
+    const std::string resourceName = uniform >= 0 ? NullGL::Config().Uniforms[uniform] : std::string();
+    GLsizei count = bufSize > 0 ? std::min((GLsizei)resourceName.size(), bufSize - 1) : 0;
+    if (bufSize > 0)
+    {
+        memcpy(name, resourceName.data(), count);
+        name[count] = '\0';
+    }
+    if (length)
+        *length = count;
+}
+
+static void GLAPIENTRY NullGetProgramResourceiv(GLuint, GLenum programInterface, GLuint index, GLsizei propCount, const GLenum* props, GLsizei bufSize, GLsizei* length, GLint* params)
+{
+    NullGL::Record("glGetProgramResourceiv");
+    GLint uniform = FindConfigUniform(programInterface, index);
+    GLsizei count = std::min(propCount, bufSize);
+    for (GLsizei i = 0; i < count; i++)
+    {
+        params[i] = 0;
+        if (uniform < 0)
+            continue;
+        switch (props[i])
+        {
+            case GL_TYPE: params[i] = GL_FLOAT_VEC4; break;
+            case GL_ARRAY_SIZE: params[i] = 1; break;
+            case GL_LOCATION: params[i] = uniform; break;
+        }
+    }
+    if (length)
+        *length = count;
+}
+
+static void GLAPIENTRY NullGetProgramiv(GLuint, GLenum pname, GLint* param)
+{
+    NullGL::Record("glGetProgramiv");
+    const NullGLConfig& config = NullGL::Config();
+    switch (pname)
+    {
+        case GL_LINK_STATUS: *param = config.LinkStatus ? GL_TRUE : GL_FALSE; break;
+        case GL_COMPLETION_STATUS_KHR: *param = GL_TRUE; break;
+        case GL_INFO_LOG_LENGTH: *param = (GLint)config.InfoLog.size() + 1; break;
+        case GL_COMPUTE_WORK_GROUP_SIZE: param[0] = param[1] = param[2] = 1; break;
+        default: *param = 0; break;
+    }
+}
+
+static void GLAPIENTRY NullGetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    NullGL::Record("glGetShaderInfoLog");
+    WriteInfoLog(bufSize, length, infoLog);
+}
+
+static void GLAPIENTRY NullGetShaderiv(GLuint shader, GLenum pname, GLint* param)
+{
+    NullGL::Record("glGetShaderiv");
+    const NullGLConfig& config = NullGL::Config();
+    switch (pname)
+    {
+        case GL_COMPILE_STATUS: *param = config.CompileStatus ? GL_TRUE : GL_FALSE; break;
+        case GL_COMPLETION_STATUS_KHR: *param = GL_TRUE; break;
+        case GL_INFO_LOG_LENGTH: *param = (GLint)config.InfoLog.size() + 1; break;
+        case GL_SHADER_TYPE: *param = (GLint)s_ShaderTypes[shader]; break;
+        default: *param = 0; break;
+    }
+}
+
+static GLint GLAPIENTRY NullGetUniformLocation(GLuint, const GLchar* name)
+{
+    // same name -> same location in every program, after the configured uniforms
+    NullGL::Record("glGetUniformLocation");
+    const std::vector<std::string>& uniforms = NullGL::Config().Uniforms;
+    auto it = std::find(uniforms.begin(), uniforms.end(), name);
+    if (it != uniforms.end())
+        return (GLint)(it - uniforms.begin());
+    GLint location = (GLint)(uniforms.size() + s_UniformLocations.size());
+    return s_UniformLocations.emplace(name, location).first->second;
+}
+
+static void GLAPIENTRY NullLinkProgram(GLuint) { NullGL::Record("glLinkProgram"); }
+static void GLAPIENTRY NullMaxShaderCompilerThreadsARB(GLuint) { NullGL::Record("glMaxShaderCompilerThreadsARB"); }
+static void GLAPIENTRY NullMaxShaderCompilerThreadsKHR(GLuint) { NullGL::Record("glMaxShaderCompilerThreadsKHR"); }
+static void GLAPIENTRY NullProgramBinary(GLuint, GLenum, const void*, GLsizei) { NullGL::Record("glProgramBinary"); }
+static void GLAPIENTRY NullProgramParameteri(GLuint, GLenum, GLint) { NullGL::Record("glProgramParameteri"); }
+static void GLAPIENTRY NullProgramUniform4fv(GLuint, GLint, GLsizei, const GLfloat*) { NullGL::Record("glProgramUniform4fv"); }
+static void GLAPIENTRY NullShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) { NullGL::Record("glShaderSource"); }
+static void GLAPIENTRY NullShaderStorageBlockBinding(GLuint, GLuint, GLuint) { NullGL::Record("glShaderStorageBlockBinding"); }
+static void GLAPIENTRY NullUniformBlockBinding(GLuint, GLuint, GLuint) { NullGL::Record("glUniformBlockBinding"); }
+static void GLAPIENTRY NullUseProgram(GLuint) { NullGL::Record("glUseProgram"); }
+static void GLAPIENTRY NullValidateProgram(GLuint) { NullGL::Record("glValidateProgram"); }
+
+static void GLAPIENTRY NullGenProgramPipelines(GLsizei n, GLuint* pipelines)
+{
+    NullGL::Record("glGenProgramPipelines");
+    GenNames(n, pipelines);
+}
+
+static void GLAPIENTRY NullGetProgramPipelineiv(GLuint, GLenum pname, GLint* param)
+{
+    NullGL::Record("glGetProgramPipelineiv");
+    switch (pname)
+    {
+        case GL_VALIDATE_STATUS: *param = GL_TRUE; break;
+        case GL_INFO_LOG_LENGTH: *param = (GLint)NullGL::Config().InfoLog.size() + 1; break;
+        default: *param = 0; break;
+    }
+}
+
+static void GLAPIENTRY NullGetProgramPipelineInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    NullGL::Record("glGetProgramPipelineInfoLog");
+    WriteInfoLog(bufSize, length, infoLog);
+}
+
+static void GLAPIENTRY NullBindProgramPipeline(GLuint) { NullGL::Record("glBindProgramPipeline"); }
+static void GLAPIENTRY NullDeleteProgramPipelines(GLsizei, const GLuint*) { NullGL::Record("glDeleteProgramPipelines"); }
+static void GLAPIENTRY NullUseProgramStages(GLuint, GLbitfield, GLuint) { NullGL::Record("glUseProgramStages"); }
+static void GLAPIENTRY NullValidateProgramPipeline(GLuint) { NullGL::Record("glValidateProgramPipeline"); }
+
+
+// direct state access
+
+static void GLAPIENTRY NullCreateBuffers(GLsizei n, GLuint* buffers)
+{
+    NullGL::Record("glCreateBuffers");
+    GenNames(n, buffers);
+}
+
+static void GLAPIENTRY NullCreateVertexArrays(GLsizei n, GLuint* arrays)
+{
+    NullGL::Record("glCreateVertexArrays");
+    GenNames(n, arrays);
+}
+
+static void GLAPIENTRY NullNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void*, GLbitfield)
+{
+    NullGL::Record("glNamedBufferStorage");
+    s_BufferStorage[buffer].assign((size_t)size, 0);
+}
+
+static void* GLAPIENTRY NullMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr, GLbitfield)
+{
+    NullGL::Record("glMapNamedBufferRange");
+    auto it = s_BufferStorage.find(buffer);
+    if (it == s_BufferStorage.end())
+        return nullptr;
+    return it->second.data() + offset;
+}
+
+static void GLAPIENTRY NullEnableVertexArrayAttrib(GLuint vaobj, GLuint index)
+{
+    NullGL::Record("glEnableVertexArrayAttrib");
+    s_VertexArrays[vaobj].Attribs[index].Enabled = true;
+}
+
+static void GLAPIENTRY NullVertexArrayAttribBinding(GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+    NullGL::Record("glVertexArrayAttribBinding");
+    s_VertexArrays[vaobj].Attribs[attribindex].Binding = bindingindex;
+}
+
+static void GLAPIENTRY NullVertexArrayAttribFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+    NullGL::Record("glVertexArrayAttribFormat");
+    NullGLVertexAttrib& attrib = s_VertexArrays[vaobj].Attribs[attribindex];
+    attrib.Size = size;
+    attrib.Type = type;
+    attrib.Normalized = normalized == GL_TRUE;
+    attrib.Offset = relativeoffset;
+}
+
+static void GLAPIENTRY NullVertexArrayBindingDivisor(GLuint vaobj, GLuint bindingindex, GLuint divisor)
+{
+    NullGL::Record("glVertexArrayBindingDivisor");
+    s_VertexArrays[vaobj].Bindings[bindingindex].Divisor = divisor;
+}
+
+static void GLAPIENTRY NullVertexArrayElementBuffer(GLuint, GLuint) { NullGL::Record("glVertexArrayElementBuffer"); }
+
+static void GLAPIENTRY NullVertexArrayVertexBuffer(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr, GLsizei stride)
+{
+    NullGL::Record("glVertexArrayVertexBuffer");
+    NullVertexBinding& binding = s_VertexArrays[vaobj].Bindings[bindingindex];
+    binding.Buffer = buffer;
+    binding.Stride = stride;
+}
+
+
+
+// compute
+
+static void GLAPIENTRY NullDispatchCompute(GLuint, GLuint, GLuint) { NullGL::Record("glDispatchCompute"); }
+static void GLAPIENTRY NullDispatchComputeIndirect(GLintptr) { NullGL::Record("glDispatchComputeIndirect"); }
+static void GLAPIENTRY NullMemoryBarrier(GLbitfield) { NullGL::Record("glMemoryBarrier"); }
+
+// queries, sync objects, debug output
+
+static GLenum GLAPIENTRY NullClientWaitSync(GLsync, GLbitfield, GLuint64)
+{
+    NullGL::Record("glClientWaitSync");
+    return GL_ALREADY_SIGNALED;
+}
+
+static void GLAPIENTRY NullDebugMessageCallback(GLDEBUGPROC, const void*) { NullGL::Record("glDebugMessageCallback"); }
+static void GLAPIENTRY NullDebugMessageControl(GLenum, GLenum, GLenum, GLsizei, const GLuint*, GLboolean) { NullGL::Record("glDebugMessageControl"); }
+static void GLAPIENTRY NullDeleteQueries(GLsizei, const GLuint*) { NullGL::Record("glDeleteQueries"); }
+static void GLAPIENTRY NullDeleteSync(GLsync) { NullGL::Record("glDeleteSync"); }
+
+static GLsync GLAPIENTRY NullFenceSync(GLenum, GLbitfield)
+{
+    NullGL::Record("glFenceSync");
+    return (GLsync)(uintptr_t)s_NextName++;
+}
+
+static void GLAPIENTRY NullGenQueries(GLsizei n, GLuint* ids)
+{
+    NullGL::Record("glGenQueries");
+    GenNames(n, ids);
+}
+
+static void GLAPIENTRY NullGetInteger64v(GLenum, GLint64* params)
+{
+    NullGL::Record("glGetInteger64v");
+    *params = 0;
+}
+
+static void GLAPIENTRY NullGetQueryObjecti64v(GLuint, GLenum, GLint64* params)
+{
+    NullGL::Record("glGetQueryObjecti64v");
+    *params = 0;
+}
+
+static void GLAPIENTRY NullGetQueryObjectiv(GLuint, GLenum pname, GLint* params)
+{
+    NullGL::Record("glGetQueryObjectiv");
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void GLAPIENTRY NullQueryCounter(GLuint, GLenum) { NullGL::Record("glQueryCounter"); }
+
+
+void NullGL::Install(const NullGLConfig& config)
+{
+    s_Config = config;
+    if (s_Installed)
+        return;
+
+#define NULL_GL_INSTALL(name) s_Driver##name = __glew##name; __glew##name = Null##name;
+    NULL_GL_FUNCTIONS(NULL_GL_INSTALL)
+#undef NULL_GL_INSTALL
+
+#define NULL_GL_INSTALL_VERSION(version) s_DriverVersion##version = __GLEW_VERSION_##version; __GLEW_VERSION_##version = GL_TRUE;
+    NULL_GL_VERSIONS(NULL_GL_INSTALL_VERSION)
+#undef NULL_GL_INSTALL_VERSION
+
+    s_DriverCore = g_GLCore;
+#define NULL_GL_INSTALL_CORE(name) g_GLCore.name = Null##name;
+    GL_CORE_FUNCTIONS(NULL_GL_INSTALL_CORE)
+#undef NULL_GL_INSTALL_CORE
+
+    s_Installed = true;
+}
+
+void NullGL::Uninstall()
+{
+    if (!s_Installed)
+        return;
+
+#define NULL_GL_UNINSTALL(name) __glew##name = s_Driver##name;
+    NULL_GL_FUNCTIONS(NULL_GL_UNINSTALL)
+#undef NULL_GL_UNINSTALL
+
+#define NULL_GL_UNINSTALL_VERSION(version) __GLEW_VERSION_##version = s_DriverVersion##version;
+    NULL_GL_VERSIONS(NULL_GL_UNINSTALL_VERSION)
+#undef NULL_GL_UNINSTALL_VERSION
+
+    g_GLCore = s_DriverCore;
+
+    s_BoundBuffers.clear();
+    s_BufferStorage.clear();
+    s_ShaderTypes.clear();
+    s_UniformLocations.clear();
+    s_BoundVertexArray = 0;
+    s_VertexArrays.clear();
+    s_Installed = false;
+}
+
+unsigned int NullGL::CountCalls(const char* function)
+{
+    unsigned int count = 0;
+    for (const char* call : s_Calls)
+    {
+        if (strcmp(call, function) == 0)
+            count++;
+    }
+    return count;
+}
+
+NullGLVertexAttrib NullGL::GetVertexAttrib(unsigned int vertexArray, unsigned int index)
+{
+    auto array = s_VertexArrays.find(vertexArray);
+    if (array == s_VertexArrays.end())
+        return NullGLVertexAttrib();
+    auto attrib = array->second.Attribs.find(index);
+    if (attrib == array->second.Attribs.end())
+        return NullGLVertexAttrib();
+
+    NullGLVertexAttrib result = attrib->second;
+    auto binding = array->second.Bindings.find(result.Binding);
+    if (binding != array->second.Bindings.end())
+    {
+        result.Buffer = binding->second.Buffer;
+        result.Stride = binding->second.Stride;
+        result.Divisor = binding->second.Divisor;
+    }
+    return result;
+}
+
+void NullGL::ClearCalls()
+{
+    s_Calls.clear();
+    s_CallCount = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct NullGLConfig
+{
+	bool CompileStatus = true;
+	bool LinkStatus = true;
+	std::string InfoLog = "null backend";  // returned for failed compiles and links
+	const char* Version = "4.6 (Core Profile) Null";
+	// active vec4 uniforms every program reports, at locations 0, 1, ...
+	std::vector<std::string> Uniforms;
+};
+
+// What a vertex array records for one attribute, see NullGL::GetVertexAttrib.
+// glVertexAttribPointer uses the binding point of the attribute's own index,
+// as in GL, so both ways of setting up a vertex array read back the same way.
+struct NullGLVertexAttrib
+{
+	bool Enabled = false;
+	int Size = 0;
+	unsigned int Type = 0;
+	bool Normalized = false;
+	unsigned int Offset = 0;   // relative offset, or the glVertexAttribPointer pointer
+	unsigned int Binding = 0;
+	// of the binding point
+	unsigned int Buffer = 0;
+	int Stride = 0;
+	unsigned int Divisor = 0;
+};
+
+// GL backend that doesn't need a context: every entry point the renderer uses
+// is replaced by a stub that records the call, hands out fake object names and
+// answers queries from NullGLConfig. Buffers that are mapped get real memory so
+// StreamBuffer works, and vertex array setup is kept so it can be read back.
+// Meant for measuring the CPU side of the renderer and for exercising code
+// paths without a driver.
+class NullGL
+{
+private:
+	static bool s_Installed;
+	static bool s_Recording;
+	static unsigned int s_CallCount;
+	static std::vector<const char*> s_Calls;
+	static NullGLConfig s_Config;
+public:
+	// Swaps the GLEW and g_GLCore pointers, Uninstall() puts the previous ones back.
+	static void Install(const NullGLConfig& config = NullGLConfig());
+	static void Uninstall();
+	inline static bool IsInstalled() { return s_Installed; }
+
+	inline static NullGLConfig& Config() { return s_Config; }
+
+	// Calls are always counted; the per-call log is only kept while recording.
+	inline static void SetRecording(bool recording) { s_Recording = recording; }
+	inline static unsigned int GetCallCount() { return s_CallCount; }
+	inline static const std::vector<const char*>& GetCalls() { return s_Calls; }
+	static unsigned int CountCalls(const char* function);
+	static void ClearCalls();
+
+	static NullGLVertexAttrib GetVertexAttrib(unsigned int vertexArray, unsigned int index);
+
+	// used by the stubs
+	inline static void Record(const char* function)
+	{
+		s_CallCount++;
+		if (s_Recording)
+			s_Calls.push_back(function);
+	}
+};
@@ -0,0 +1,249 @@
+#include "Profiler.h"
+#include "Renderer.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+
+static const unsigned int NoQuery = 0xFFFFFFFF;
+
+bool Profiler::s_GpuTiming = false;
+int64_t Profiler::s_GpuOffset = 0;
+uint64_t Profiler::s_FrameIndex = 0;
+unsigned int Profiler::s_Slot = 0;
+Profiler::FrameSlot Profiler::s_Slots[FrameLatency];
+std::vector<unsigned int> Profiler::s_OpenScopes;
+ProfileFrame Profiler::s_LastFrame;
+std::ofstream Profiler::s_Trace;
+
+int64_t Profiler::Now()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Profiler::Init(bool gpuTiming)
+{
+    s_GpuTiming = gpuTiming && (GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+    if (gpuTiming && !s_GpuTiming)
+        std::cout << "GL_TIMESTAMP queries not supported, profiling CPU only" << std::endl;
+
+    if (s_GpuTiming)
+    {
+        // GPU and CPU clocks have different origins, line them up once
+        GLint64 gpuTime;
+        GLCall(glGetInteger64v(GL_TIMESTAMP, &gpuTime));
+        s_GpuOffset = Now() - gpuTime;
+    }
+}
+
+void Profiler::Shutdown()
+{
+    EndTrace();
+    for (FrameSlot& slot : s_Slots)
+    {
+        if (!slot.Queries.empty())
+        {
+            GLCall(glDeleteQueries((GLsizei)slot.Queries.size(), slot.Queries.data()));
+        }
+        slot = FrameSlot();
+    }
+    s_GpuTiming = false;
+}
+
+unsigned int Profiler::IssueTimestamp(FrameSlot& slot)
+{
+    if (!s_GpuTiming)
+        return NoQuery;
+
+    if (slot.QueryCount == slot.Queries.size())
+    {
+        // the pool grows to the largest frame seen and is then reused
+        unsigned int query;
+        GLCall(glGenQueries(1, &query));
+        slot.Queries.push_back(query);
+    }
+    GLCall(glQueryCounter(slot.Queries[slot.QueryCount], GL_TIMESTAMP));
+    return slot.QueryCount++;
+}
+
+void Profiler::BeginScope(const char* name)
+{
+    FrameSlot& slot = s_Slots[s_Slot];
+    s_OpenScopes.push_back((unsigned int)slot.Scopes.size());
+    slot.Scopes.push_back({ name, (unsigned int)s_OpenScopes.size() - 1, Now(), 0, NoQuery, NoQuery });
+    slot.Scopes.back().QueryBegin = IssueTimestamp(slot);
+}
+
+void Profiler::EndScope()
+{
+    FrameSlot& slot = s_Slots[s_Slot];
+    ScopeRecord& scope = slot.Scopes[s_OpenScopes.back()];
+    s_OpenScopes.pop_back();
+    scope.QueryEnd = IssueTimestamp(slot);
+    scope.CpuEnd = Now();
+}
+
+void Profiler::EndFrame()
+{
+    // a scope can't span frames, EndFrame has to be outside every PROFILE_SCOPE
+    ASSERT(s_OpenScopes.empty());
+
+    FrameSlot& current = s_Slots[s_Slot];
+    current.Index = s_FrameIndex++;
+    current.Pending = true;
+    s_Slot = (s_Slot + 1) % FrameLatency;
+
+    // resolve finished frames oldest first; the slot about to be reused is
+    // resolved even if the GPU hasn't caught up yet
+    for (unsigned int i = 0; i < FrameLatency; i++)
+    {
+        FrameSlot& slot = s_Slots[(s_Slot + i) % FrameLatency];
+        if (!slot.Pending)
+            continue;
+
+        GLint available = GL_TRUE;
+        if (slot.QueryCount > 0)
+        {
+            // timestamps complete in order, the last one decides
+            GLCall(glGetQueryObjectiv(slot.Queries[slot.QueryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+        }
+        if (!available && i > 0)
+            break;
+        ResolveFrame(slot, s_GpuTiming && available);
+    }
+
+    FrameSlot& next = s_Slots[s_Slot];
+    next.Scopes.clear();
+    next.QueryCount = 0;
+}
+
+void Profiler::ResolveFrame(FrameSlot& slot, bool gpuValid)
+{
+    slot.Pending = false;
+
+    std::vector<int64_t> gpuTimes;
+    if (gpuValid)
+    {
+        gpuTimes.resize(slot.QueryCount);
+        for (unsigned int i = 0; i < slot.QueryCount; i++)
+        {
+            GLint64 time;
+            GLCall(glGetQueryObjecti64v(slot.Queries[i], GL_QUERY_RESULT, &time));
+            gpuTimes[i] = time + s_GpuOffset;
+        }
+    }
+
+    ProfileFrame& frame = s_LastFrame;
+    frame.Index = slot.Index;
+    frame.GpuValid = gpuValid;
+    frame.Nodes.clear();
+
+    // node of the innermost open scope at each depth while walking the records
+    std::vector<int> path;
+    for (const ScopeRecord& scope : slot.Scopes)
+    {
+        path.resize(scope.Depth);
+        const int parent = scope.Depth > 0 ? path[scope.Depth - 1] : -1;
+
+        int node = -1;
+        for (int i = parent + 1; i < (int)frame.Nodes.size(); i++)
+        {
+            if (frame.Nodes[i].Parent == parent && strcmp(frame.Nodes[i].Name, scope.Name) == 0)
+            {
+                node = i;
+                break;
+            }
+        }
+        if (node < 0)
+        {
+            node = (int)frame.Nodes.size();
+            frame.Nodes.push_back({ scope.Name, parent, scope.Depth, 0, 0.0, 0.0 });
+        }
+        path.push_back(node);
+
+        ProfileNode& entry = frame.Nodes[node];
+        entry.Count++;
+        entry.CpuTime += (scope.CpuEnd - scope.CpuBegin) / 1e6;
+        // scopes recorded before Init() have no queries
+        const bool hasGpuTime = gpuValid && scope.QueryBegin != NoQuery && scope.QueryEnd != NoQuery;
+        if (hasGpuTime)
+            entry.GpuTime += (gpuTimes[scope.QueryEnd] - gpuTimes[scope.QueryBegin]) / 1e6;
+
+        if (s_Trace.is_open())
+        {
+            WriteTraceEvent(scope.Name, 0, scope.CpuBegin, scope.CpuEnd);
+            if (hasGpuTime)
+                WriteTraceEvent(scope.Name, 1, gpuTimes[scope.QueryBegin], gpuTimes[scope.QueryEnd]);
+        }
+    }
+}
+
+static void PrintNodes(const ProfileFrame& frame, int parent)
+{
+    for (int i = parent + 1; i < (int)frame.Nodes.size(); i++)
+    {
+        const ProfileNode& node = frame.Nodes[i];
+        if (node.Parent != parent)
+            continue;
+
+        std::cout << std::string(node.Depth * 2 + 2, ' ') << std::left << std::setw(32 - node.Depth * 2) << node.Name <<
+            std::right << std::setw(10) << node.CpuTime << " ms cpu";
+        if (frame.GpuValid)
+            std::cout << std::setw(10) << node.GpuTime << " ms gpu";
+        if (node.Count > 1)
+            std::cout << "  x" << node.Count;
+        std::cout << std::endl;
+
+        PrintNodes(frame, i);
+    }
+}
+
+void Profiler::PrintFrame(const ProfileFrame& frame)
+{
+    // the rest of the program prints with the stream's own format
+    const std::ios_base::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << "Frame " << frame.Index << std::endl << std::fixed << std::setprecision(3);
+    PrintNodes(frame, -1);
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+bool Profiler::BeginTrace(const std::string& filepath)
+{
+    EndTrace();
+    s_Trace.open(filepath);
+    if (!s_Trace)
+        return false;
+
+    s_Trace << "{\"traceEvents\":[" << std::endl;
+    s_Trace << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}}," << std::endl;
+    s_Trace << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+    return true;
+}
+
+void Profiler::EndTrace()
+{
+    if (!s_Trace.is_open())
+        return;
+
+    s_Trace << std::endl << "]}" << std::endl;
+    s_Trace.close();
+}
+
+void Profiler::WriteTraceEvent(const char* name, unsigned int thread, int64_t begin, int64_t end)
+{
+    s_Trace << "," << std::endl << "{\"name\":\"";
+    for (const char* c = name; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            s_Trace << '\\';
+        s_Trace << *c;
+    }
+    // trace_event times are in microseconds
+    s_Trace << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread << std::fixed << std::setprecision(3) <<
+        ",\"ts\":" << begin / 1e3 << ",\"dur\":" << (end - begin) / 1e3 << "}";
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef PROFILING
+	#define PROFILING 1
+#endif
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+// PROFILE_SCOPE("name") times the rest of the enclosing block on the CPU and,
+// after Profiler::Init(true), on the GPU. The name has to be a string literal
+// (or otherwise outlive the profiler), only the pointer is stored.
+#if PROFILING
+	#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+	#define PROFILE_SCOPE(name)
+#endif
+
+
+// One node per distinct scope name under the same parent. Scopes entered
+// several times in a frame (e.g. in a loop) are summed into the same node.
+struct ProfileNode
+{
+	const char* Name;
+	int Parent;            // index into ProfileFrame::Nodes, -1 for top level
+	unsigned int Depth;
+	unsigned int Count;
+	double CpuTime;        // ms
+	double GpuTime;        // ms, only valid if the frame's GpuValid is set
+};
+
+struct ProfileFrame
+{
+	uint64_t Index = 0;
+	bool GpuValid = false;
+	std::vector<ProfileNode> Nodes;  // parents come before their children
+};
+
+// Frame profiler. Scopes are recorded into the current frame until EndFrame().
+// GPU timestamps (GL_TIMESTAMP queries) are read back FrameLatency frames
+// later, and only if they are already available, so the profiler never waits
+// for the GPU; if a frame's results are still pending when its queries have
+// to be reused the frame is resolved without GPU times.
+class Profiler
+{
+public:
+	static constexpr unsigned int FrameLatency = 3;
+private:
+	struct ScopeRecord
+	{
+		const char* Name;
+		unsigned int Depth;
+		int64_t CpuBegin;     // ns since profiler start
+		int64_t CpuEnd;
+		unsigned int QueryBegin;  // index into the frame's query pool
+		unsigned int QueryEnd;
+	};
+
+	struct FrameSlot
+	{
+		uint64_t Index = 0;
+		bool Pending = false;
+		std::vector<ScopeRecord> Scopes;
+		std::vector<unsigned int> Queries;
+		unsigned int QueryCount = 0;
+	};
+
+	static bool s_GpuTiming;
+	static int64_t s_GpuOffset;  // added to GL_TIMESTAMP values to get profiler time
+	static uint64_t s_FrameIndex;
+	static unsigned int s_Slot;
+	static FrameSlot s_Slots[FrameLatency];
+	static std::vector<unsigned int> s_OpenScopes;
+	static ProfileFrame s_LastFrame;
+
+	static std::ofstream s_Trace;
+public:
+	// Call once the context is current. GPU timing needs GL 3.3 or ARB_timer_query.
+	static void Init(bool gpuTiming);
+	static void Shutdown();
+
+	static void BeginScope(const char* name);
+	static void EndScope();
+	static void EndFrame();
+
+	// Last frame with resolved results, FrameLatency frames behind EndFrame().
+	inline static const ProfileFrame& GetLastFrame() { return s_LastFrame; }
+	static void PrintFrame(const ProfileFrame& frame);
+
+	// Chrome trace_event JSON (chrome://tracing, Perfetto). Every resolved
+	// frame is appended until EndTrace().
+	static bool BeginTrace(const std::string& filepath);
+	static void EndTrace();
+private:
+	static int64_t Now();
+	static unsigned int IssueTimestamp(FrameSlot& slot);
+	static void ResolveFrame(FrameSlot& slot, bool gpuValid);
+	static void WriteTraceEvent(const char* name, unsigned int thread, int64_t begin, int64_t end);
+};
+
+class ProfileScope
+{
+public:
+	inline ProfileScope(const char* name) { Profiler::BeginScope(name); }
+	inline ~ProfileScope() { Profiler::EndScope(); }
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
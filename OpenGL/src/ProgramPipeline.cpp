@@ -0,0 +1,138 @@
+#include <iostream>
+#include <string>
+
+#include "ProgramPipeline.h"
+#include "Renderer.h"
+
+
+std::map<ProgramPipeline::PipelineKey, unsigned int> ProgramPipeline::s_Pipelines;
+
+// in PipelineKey order
+static const unsigned int StageBits[ProgramPipeline::StageCount] = {
+    GL_VERTEX_SHADER_BIT, GL_TESS_CONTROL_SHADER_BIT, GL_TESS_EVALUATION_SHADER_BIT,
+    GL_GEOMETRY_SHADER_BIT, GL_FRAGMENT_SHADER_BIT
+};
+
+ProgramPipeline::ProgramPipeline(std::initializer_list<std::shared_ptr<Shader>> stages)
+    : m_Stages(stages), m_Key(), m_RendererID(0)
+{
+    for (const std::shared_ptr<Shader>& stage : m_Stages)
+    {
+        if (!stage->IsSeparable())
+            std::cout << stage->GetFilepath() << " isn't separable, load it with ShaderLibrary::LoadSeparable!" << std::endl;
+        ASSERT(stage->IsSeparable());
+    }
+}
+
+void ProgramPipeline::Bind() const
+{
+    // a stage program changes when its shader is reloaded
+    const PipelineKey key = MakeKey();
+    if (key != m_Key || !m_RendererID)
+    {
+        auto it = s_Pipelines.find(key);
+        if (it == s_Pipelines.end())
+            it = s_Pipelines.emplace(key, CreatePipeline(key)).first;
+        m_Key = key;
+        m_RendererID = it->second;
+    }
+    Renderer::State().BindProgramPipeline(m_RendererID);
+}
+
+void ProgramPipeline::Unbind() const
+{
+    Renderer::State().BindProgramPipeline(0);
+}
+
+bool ProgramPipeline::IsReady() const
+{
+    for (const std::shared_ptr<Shader>& stage : m_Stages)
+    {
+        if (!stage->IsReady())
+            return false;
+    }
+    return true;
+}
+
+void ProgramPipeline::FlushUniforms() const
+{
+    for (const std::shared_ptr<Shader>& stage : m_Stages)
+        stage->FlushUniforms();
+}
+
+unsigned int ProgramPipeline::GetPrimitiveType() const
+{
+    for (const std::shared_ptr<Shader>& stage : m_Stages)
+    {
+        if (stage->GetPrimitiveType() == GL_PATCHES)
+            return GL_PATCHES;
+    }
+    return GL_TRIANGLES;
+}
+
+void ProgramPipeline::ReleaseProgram(unsigned int program)
+{
+    for (auto it = s_Pipelines.begin(); it != s_Pipelines.end(); )
+    {
+        bool uses = false;
+        for (unsigned int stage : it->first)
+            uses |= stage == program;
+
+        if (uses)
+        {
+            Renderer::State().DeleteProgramPipeline(it->second);
+            it = s_Pipelines.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+ProgramPipeline::PipelineKey ProgramPipeline::MakeKey() const
+{
+    PipelineKey key = {};
+    for (const std::shared_ptr<Shader>& stage : m_Stages)
+    {
+        const unsigned int bits = stage->GetStageBits();
+        for (unsigned int i = 0; i < StageCount; i++)
+        {
+            if (bits & StageBits[i])
+            {
+                ASSERT(key[i] == 0);
+                key[i] = stage->GetRendererID();
+            }
+        }
+    }
+    return key;
+}
+
+unsigned int ProgramPipeline::CreatePipeline(const PipelineKey& key)
+{
+    unsigned int pipeline;
+    GLCall(glGenProgramPipelines(1, &pipeline));
+    for (unsigned int i = 0; i < StageCount; i++)
+    {
+        if (key[i])
+        {
+            GLCall(glUseProgramStages(pipeline, StageBits[i], key[i]));
+        }
+    }
+
+    // mismatched interfaces between the stages only show up here
+    GLCall(glValidateProgramPipeline(pipeline));
+    int valid;
+    GLCall(glGetProgramPipelineiv(pipeline, GL_VALIDATE_STATUS, &valid));
+    if (valid == GL_FALSE)
+    {
+        int length;
+        GLCall(glGetProgramPipelineiv(pipeline, GL_INFO_LOG_LENGTH, &length));
+        std::string message(length, '\0');
+        if (length > 0)
+        {
+            GLCall(glGetProgramPipelineInfoLog(pipeline, length, &length, &message[0]));
+        }
+        std::cout << "Program pipeline failed to validate!" << std::endl;
+        std::cout << message << std::endl;
+    }
+    return pipeline;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Shader.h"
+
+// Draws with separable programs (ShaderLibrary::LoadSeparable) combined in a
+// program pipeline object, so a new combination of stages only costs a
+// glUseProgramStages instead of compiling and linking a program of its own.
+//
+// Pipeline objects are cached by the programs they are made of and shared by
+// every ProgramPipeline with the same stages. A reloaded stage gets a new
+// program, so Bind() picks up the matching pipeline by itself.
+//
+// Uniforms are set on the stage shaders; they upload with glProgramUniform*,
+// so nothing has to be bound for that. Each stage may only come from one of
+// the shaders.
+class ProgramPipeline
+{
+public:
+	// vertex, tess control, tess evaluation, geometry, fragment
+	static constexpr unsigned int StageCount = 5;
+private:
+	using PipelineKey = std::array<unsigned int, StageCount>;  // program of each stage, 0 if unused
+	static std::map<PipelineKey, unsigned int> s_Pipelines;
+
+	std::vector<std::shared_ptr<Shader>> m_Stages;
+	// pipeline of the programs Bind() last saw
+	mutable PipelineKey m_Key;
+	mutable unsigned int m_RendererID;
+public:
+	ProgramPipeline(std::initializer_list<std::shared_ptr<Shader>> stages);
+
+	void Bind() const;
+	void Unbind() const;
+
+	// every stage program is ready
+	bool IsReady() const;
+	void FlushUniforms() const;
+
+	inline const std::vector<std::shared_ptr<Shader>>& GetStages() const { return m_Stages; }
+	// GL_PATCHES when a stage has tessellation, GL_TRIANGLES otherwise
+	unsigned int GetPrimitiveType() const;
+
+	// Deletes the cached pipelines that use program. Shader calls this before
+	// deleting a separable program, a recycled id must not find them.
+	static void ReleaseProgram(unsigned int program);
+	inline static unsigned int GetPipelineCount() { return (unsigned int)s_Pipelines.size(); }
+private:
+	PipelineKey MakeKey() const;
+	static unsigned int CreatePipeline(const PipelineKey& key);
+};
@@ -1,8 +1,19 @@
 #include <iostream>
+#include <utility>
 
 #include "Renderer.h"
+#include "Shader.h"
+#include "ProgramPipeline.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Material.h"
 
 
+GLCallSite g_GLCallSite = { "", "", 0 };
+bool g_GLDebugOutput = false;
+bool g_GLDebugError = false;
+unsigned int g_GLCallCount = 0;
+
 void GLClearError()
 {
     while (glGetError() != GL_NO_ERROR);
@@ -13,8 +24,506 @@ bool GLLogCall(const char* function, const char* file, int line)
     while (GLenum error = glGetError())
     {
         std::cout << "[OpenGL error] (" << error << "): " <<
-            function << " line: " << line << std::endl;
+            function << " " << file << " line: " << line << std::endl;
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+#if GL_CHECK_LEVEL == GL_CHECK_CALLBACK
+static void GLAPIENTRY GLDebugMessage(GLenum source, GLenum type, GLuint id, GLenum /*severity*/,
+    GLsizei /*length*/, const GLchar* message, const void* /*userParam*/)
+{
+    // Shader prints compile errors from the info log; they aren't errors of
+    // the GL call either, a reload of a broken file must not stop the program
+    if (source == GL_DEBUG_SOURCE_SHADER_COMPILER)
+        return;
+
+    if (type == GL_DEBUG_TYPE_ERROR)
+    {
+        // synchronous output -> the callback runs inside the call GLCall recorded
+        std::cout << "[OpenGL error] (" << id << "): " << message << std::endl <<
+            "    " << g_GLCallSite.Function << " " << g_GLCallSite.File <<
+            " line: " << g_GLCallSite.Line << std::endl;
+        g_GLDebugError = true;
+    }
+    else
+    {
+        std::cout << "[OpenGL debug] (" << id << "): " << message << std::endl;
+    }
+}
+#endif
+
+bool GLEnableDebugOutput()
+{
+#if GL_CHECK_LEVEL == GL_CHECK_CALLBACK
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+        return false;
+
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(GLDebugMessage, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+
+    g_GLDebugOutput = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+StateCache Renderer::s_StateCache;
+RendererStats Renderer::s_Stats;
+RendererStats Renderer::s_FrameStats;
+unsigned int Renderer::s_StatsFrame = 0;
+unsigned int Renderer::s_StatsPrintInterval = 0;
+bool Renderer::s_DirectStateAccess = true;
+
+StateCache::StateCache()
+{
+    Invalidate();
+}
+
+void StateCache::UseProgram(unsigned int program)
+{
+    if (m_Program == program)
+    {
+        m_Stats.ProgramBindsElided++;
+        return;
+    }
+    GLCall(glUseProgram(program));
+    m_Program = program;
+    m_Stats.ProgramBinds++;
+}
+
+void StateCache::BindProgramPipeline(unsigned int pipeline)
+{
+    UseProgram(0);
+    if (m_ProgramPipeline == pipeline)
+    {
+        m_Stats.ProgramBindsElided++;
+        return;
+    }
+    GLCall(glBindProgramPipeline(pipeline));
+    m_ProgramPipeline = pipeline;
+    m_Stats.ProgramBinds++;
+}
+
+void StateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (m_VertexArray == vertexArray)
+    {
+        m_Stats.VertexArrayBindsElided++;
+        return;
+    }
+    GLCall(glBindVertexArray(vertexArray));
+    m_VertexArray = vertexArray;
+    m_Stats.VertexArrayBinds++;
+}
+
+void StateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    unsigned int* current = nullptr;
+    switch (target)
+    {
+        case GL_ARRAY_BUFFER:
+            current = &m_ArrayBuffer;
+            break;
+        case GL_DRAW_INDIRECT_BUFFER:
+            current = &m_DrawIndirectBuffer;
+            break;
+        case GL_DISPATCH_INDIRECT_BUFFER:
+            current = &m_DispatchIndirectBuffer;
+            break;
+        case GL_ELEMENT_ARRAY_BUFFER:
+            // without a known vertex array we can't tell what is bound
+            if (m_VertexArray != Unknown)
+            {
+                auto it = m_ElementBuffers.find(m_VertexArray);
+                if (it == m_ElementBuffers.end())
+                    it = m_ElementBuffers.emplace(m_VertexArray, Unknown).first;
+                current = &it->second;
+            }
+            break;
+    }
+
+    if (current && *current == buffer)
+    {
+        m_Stats.BufferBindsElided++;
+        return;
+    }
+    GLCall(glBindBuffer(target, buffer));
+    if (current)
+        *current = buffer;
+    m_Stats.BufferBinds++;
+}
+
+void StateCache::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+    ASSERT(unit < MaxTextureUnits);
+    if (m_TextureTargets[unit] == target && m_Textures[unit] == texture)
+    {
+        m_Stats.TextureBindsElided++;
+        return;
+    }
+    ActiveTexture(unit);
+    GLCall(glBindTexture(target, texture));
+    m_TextureTargets[unit] = target;
+    m_Textures[unit] = texture;
+    m_Stats.TextureBinds++;
+}
+
+void StateCache::ActiveTexture(unsigned int unit)
+{
+    if (m_ActiveTextureUnit == unit)
+        return;
+    GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    m_ActiveTextureUnit = unit;
+}
+
+void StateCache::SetElementBuffer(unsigned int vertexArray, unsigned int buffer)
+{
+    unsigned int& current = m_ElementBuffers.emplace(vertexArray, Unknown).first->second;
+    if (current == buffer)
+    {
+        m_Stats.BufferBindsElided++;
+        return;
+    }
+    GLCall(glVertexArrayElementBuffer(vertexArray, buffer));
+    current = buffer;
+    m_Stats.BufferBinds++;
+}
+
+void StateCache::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+    BufferRange* current = nullptr;
+    if (index < MaxBufferBindings)
+    {
+        if (target == GL_UNIFORM_BUFFER)
+            current = &m_UniformBuffers[index];
+        else if (target == GL_SHADER_STORAGE_BUFFER)
+            current = &m_StorageBuffers[index];
+    }
+
+    if (current && current->Buffer == buffer && current->Offset == offset && current->Size == size)
+    {
+        m_Stats.BufferRangeBindsElided++;
+        return;
+    }
+    GLCall(glBindBufferRange(target, index, buffer, offset, size));
+    if (current)
+        *current = { buffer, offset, size };
+    m_Stats.BufferRangeBinds++;
+}
+
+void StateCache::DeleteProgram(unsigned int program)
+{
+    GLCall(glDeleteProgram(program));
+    // a program in use is only flagged for deletion, forget it so the id can be reused
+    if (m_Program == program)
+        m_Program = Unknown;
+}
+
+void StateCache::DeleteProgramPipeline(unsigned int pipeline)
+{
+    GLCall(glDeleteProgramPipelines(1, &pipeline));
+    if (m_ProgramPipeline == pipeline)
+        m_ProgramPipeline = 0;
+}
+
+void StateCache::DeleteVertexArray(unsigned int vertexArray)
+{
+    GLCall(glDeleteVertexArrays(1, &vertexArray));
+    m_ElementBuffers.erase(vertexArray);
+    if (m_VertexArray == vertexArray)
+        m_VertexArray = 0;
+}
+
+void StateCache::DeleteBuffer(unsigned int buffer)
+{
+    GLCall(glDeleteBuffers(1, &buffer));
+    if (m_ArrayBuffer == buffer)
+        m_ArrayBuffer = 0;
+    if (m_DrawIndirectBuffer == buffer)
+        m_DrawIndirectBuffer = 0;
+    if (m_DispatchIndirectBuffer == buffer)
+        m_DispatchIndirectBuffer = 0;
+    // vertex arrays that aren't bound keep referencing the deleted buffer, so
+    // a recycled id must not look like it is already attached to them
+    for (auto& element : m_ElementBuffers)
+    {
+        if (element.second == buffer)
+            element.second = element.first == m_VertexArray ? 0 : Unknown;
+    }
+    for (unsigned int i = 0; i < MaxBufferBindings; i++)
+    {
+        if (m_UniformBuffers[i].Buffer == buffer)
+            m_UniformBuffers[i] = { 0, 0, 0 };
+        if (m_StorageBuffers[i].Buffer == buffer)
+            m_StorageBuffers[i] = { 0, 0, 0 };
+    }
+}
+
+void StateCache::DeleteTexture(unsigned int texture)
+{
+    GLCall(glDeleteTextures(1, &texture));
+    for (unsigned int i = 0; i < MaxTextureUnits; i++)
+    {
+        if (m_Textures[i] == texture)
+            m_Textures[i] = 0;
+    }
+}
+
+void StateCache::Invalidate()
+{
+    m_Program = Unknown;
+    m_ProgramPipeline = Unknown;
+    m_VertexArray = Unknown;
+    m_ArrayBuffer = Unknown;
+    m_DrawIndirectBuffer = Unknown;
+    m_DispatchIndirectBuffer = Unknown;
+    m_ElementBuffers.clear();
+    m_ActiveTextureUnit = Unknown;
+    for (unsigned int i = 0; i < MaxTextureUnits; i++)
+    {
+        m_TextureTargets[i] = Unknown;
+        m_Textures[i] = Unknown;
+    }
+    for (unsigned int i = 0; i < MaxBufferBindings; i++)
+    {
+        m_UniformBuffers[i] = { Unknown, 0, 0 };
+        m_StorageBuffers[i] = { Unknown, 0, 0 };
+    }
+}
+
+
+bool Renderer::HasDirectStateAccess()
+{
+    return s_DirectStateAccess && (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access);
+}
+
+void Renderer::Clear() const
+{
+    GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+}
+
+void Renderer::SetDepthTest(bool enabled) const
+{
+    if (enabled)
+    {
+        GLCall(glEnable(GL_DEPTH_TEST));
+    }
+    else
+    {
+        GLCall(glDisable(GL_DEPTH_TEST));
+    }
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+{
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElements(shader.GetPrimitiveType(), ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+    CountDraw(ib.GetCount());
+}
+
+void Renderer::DrawElementsInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElementsInstanced(shader.GetPrimitiveType(), ib.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
+    CountDraw(ib.GetCount(), instanceCount);
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const ProgramPipeline& pipeline) const
+{
+    DrawElementsInstanced(va, ib, pipeline, 1);
+}
+
+void Renderer::DrawElementsInstanced(const VertexArray& va, const IndexBuffer& ib, const ProgramPipeline& pipeline, unsigned int instanceCount) const
+{
+    if (!pipeline.IsReady())
+        return;
+
+    pipeline.Bind();
+    pipeline.FlushUniforms();
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElementsInstanced(pipeline.GetPrimitiveType(), ib.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
+    CountDraw(ib.GetCount(), instanceCount);
+}
+
+void Renderer::Dispatch(Shader& shader, unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ)
+{
+    ASSERT(shader.IsCompute());
+    if (groupsX == 0 || groupsY == 0 || groupsZ == 0)
+        return;
+
+    shader.Bind();
+    shader.FlushUniforms();
+    GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
+    s_Stats.Dispatches++;
+}
+
+void Renderer::DispatchIndirect(Shader& shader, unsigned int buffer, unsigned int offset)
+{
+    ASSERT(shader.IsCompute());
+    ASSERT(offset % 4 == 0);
+
+    shader.Bind();
+    shader.FlushUniforms();
+    s_StateCache.BindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buffer);
+    GLCall(glDispatchComputeIndirect((GLintptr)offset));
+    s_Stats.Dispatches++;
+}
+
+void Renderer::Barrier(unsigned int barriers)
+{
+    GLCall(glMemoryBarrier(barriers));
+}
+
+void Renderer::Submit(Shader& shader, const VertexArray& va, const IndexBuffer& ib, const Material* material)
+{
+    m_Queue.push_back({ &shader, &va, &ib, material });
+}
+
+void Renderer::Flush()
+{
+    SortQueue();
+
+    Shader* shader = nullptr;
+    const VertexArray* va = nullptr;
+    const IndexBuffer* ib = nullptr;
+    const Material* material = nullptr;
+
+    for (const SortEntry& entry : m_SortEntries)
+    {
+        const DrawCommand& command = m_Queue[entry.Index];
+
+        // programs still compiling are skipped instead of stalling the frame
+        if (command.Program != shader && !command.Program->IsReady())
+            continue;
+
+        if (command.Program != shader)
+        {
+            command.Program->Bind();
+            shader = command.Program;
+            material = nullptr;  // uniforms belong to the program
+        }
+        if (command.Vertices != va)
+        {
+            command.Vertices->Bind();
+            va = command.Vertices;
+            ib = nullptr;
+        }
+        if (command.Indices != ib)
+        {
+            command.Indices->Bind();
+            ib = command.Indices;
+        }
+        if (command.Uniforms != material)
+        {
+            if (command.Uniforms)
+                command.Uniforms->Apply(*shader);
+            material = command.Uniforms;
+        }
+        shader->FlushUniforms();
+
+        GLCall(glDrawElements(shader->GetPrimitiveType(), ib->GetCount(), GL_UNSIGNED_INT, nullptr));
+        CountDraw(ib->GetCount());
+    }
+
+    m_Queue.clear();
+}
+
+void Renderer::EndFrame()
+{
+    s_Stats.Binds = s_StateCache.GetStats();
+    s_Stats.GLCalls = g_GLCallCount;
+    s_FrameStats = s_Stats;
+
+    s_Stats = RendererStats();
+    s_StateCache.ResetStats();
+    g_GLCallCount = 0;
+
+    s_StatsFrame++;
+    if (s_StatsPrintInterval && s_StatsFrame % s_StatsPrintInterval == 0)
+        PrintStats(s_FrameStats);
+}
+
+static void PrintBinds(const char* name, unsigned int issued, unsigned int elided)
+{
+    std::cout << "  " << name << " binds: " << issued << " (" << elided << " elided)" << std::endl;
+}
+
+void Renderer::PrintStats(const RendererStats& stats)
+{
+    std::cout << "Frame " << s_StatsFrame << ": " << stats.DrawCalls << " draws, " << stats.Indices << " indices, " <<
+        stats.Instances << " instances, " << stats.Dispatches << " dispatches" << std::endl;
+    PrintBinds("program", stats.Binds.ProgramBinds, stats.Binds.ProgramBindsElided);
+    PrintBinds("vertex array", stats.Binds.VertexArrayBinds, stats.Binds.VertexArrayBindsElided);
+    PrintBinds("buffer", stats.Binds.BufferBinds, stats.Binds.BufferBindsElided);
+    PrintBinds("buffer range", stats.Binds.BufferRangeBinds, stats.Binds.BufferRangeBindsElided);
+    PrintBinds("texture", stats.Binds.TextureBinds, stats.Binds.TextureBindsElided);
+    std::cout << "  uniform uploads: " << stats.UniformUploads << ", uploaded: " << stats.BytesUploaded <<
+        " B, streamed: " << stats.BytesStreamed << " B";
+#if GL_COUNT_CALLS
+    std::cout << ", GL calls: " << stats.GLCalls;
+#endif
+    std::cout << std::endl;
+}
+
+uint64_t Renderer::MakeSortKey(const DrawCommand& command)
+{
+    // ids are truncated to 16 bits; a collision only costs an extra state change
+    uint64_t program = command.Program->GetRendererID() & 0xFFFF;
+    uint64_t vertexArray = command.Vertices->GetRendererID() & 0xFFFF;
+    uint64_t material = (command.Uniforms ? command.Uniforms->GetID() : 0) & 0xFFFF;
+    uint64_t indexBuffer = command.Indices->GetRendererID() & 0xFFFF;
+    return (program << 48) | (vertexArray << 32) | (material << 16) | indexBuffer;
+}
+
+void Renderer::SortQueue()
+{
+    const unsigned int count = (unsigned int)m_Queue.size();
+    m_SortEntries.resize(count);
+    m_SortScratch.resize(count);
+
+    // LSD radix sort, 8 bits per pass. All histograms are built in one go
+    // and passes where every key has the same digit are skipped.
+    unsigned int histograms[8][256] = {};
+    for (unsigned int i = 0; i < count; i++)
+    {
+        uint64_t key = MakeSortKey(m_Queue[i]);
+        m_SortEntries[i] = { key, i };
+        for (unsigned int pass = 0; pass < 8; pass++)
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    SortEntry* src = m_SortEntries.data();
+    SortEntry* dst = m_SortScratch.data();
+    for (unsigned int pass = 0; pass < 8; pass++)
+    {
+        unsigned int* histogram = histograms[pass];
+        if (count == 0 || histogram[(src[0].Key >> (pass * 8)) & 0xFF] == count)
+            continue;
+
+        unsigned int offset = 0;
+        for (unsigned int digit = 0; digit < 256; digit++)
+        {
+            unsigned int digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+        for (unsigned int i = 0; i < count; i++)
+            dst[histogram[(src[i].Key >> (pass * 8)) & 0xFF]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    if (src != m_SortEntries.data())
+        m_SortEntries.swap(m_SortScratch);
+}
@@ -1,11 +1,298 @@
 #pragma once
 
-#include <GL/glew.h>
+#include "GLBackend.h"
 
-#define ASSERT(x) if (!(x)) __debugbreak();
-#define GLCall(x) GLClearError(); x; ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
+class Shader;
+class ProgramPipeline;
+class VertexArray;
+class IndexBuffer;
+class Material;
+
+// GL error checking levels:
+//   OFF      - GLCall(x) is just x, nothing is checked
+//   CALLBACK - errors are reported by the KHR_debug message callback, GLCall only records the call site
+//   FULL     - glGetError before and after every call
+#define GL_CHECK_OFF 0
+#define GL_CHECK_CALLBACK 1
+#define GL_CHECK_FULL 2
+
+#ifndef GL_CHECK_LEVEL
+	#ifdef NDEBUG
+		#define GL_CHECK_LEVEL GL_CHECK_OFF
+	#else
+		#define GL_CHECK_LEVEL GL_CHECK_CALLBACK
+	#endif
+#endif
+
+#ifdef _MSC_VER
+	#define DEBUG_BREAK() __debugbreak()
+#else
+	#include <csignal>
+	#define DEBUG_BREAK() raise(SIGTRAP)
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+// RendererStats::GLCalls counts the calls made through GLCall. That is on
+// wherever errors are checked; with GL_CHECK_OFF GLCall(x) stays just x
+// unless GL_COUNT_CALLS=1 is defined.
+#ifndef GL_COUNT_CALLS
+	#define GL_COUNT_CALLS (GL_CHECK_LEVEL != GL_CHECK_OFF)
+#endif
+
+#if GL_COUNT_CALLS
+	#define GL_COUNT_CALL() g_GLCallCount++
+#else
+	#define GL_COUNT_CALL()
+#endif
+
+#if GL_CHECK_LEVEL == GL_CHECK_FULL
+	#define GLCall(x) GLClearError(); x; GL_COUNT_CALL(); ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#elif GL_CHECK_LEVEL == GL_CHECK_CALLBACK
+	#define GLCall(x) GLBeginCall(#x, __FILE__, __LINE__); x; GL_COUNT_CALL(); ASSERT(GLEndCall())
+#elif GL_COUNT_CALLS
+	#define GLCall(x) x; GL_COUNT_CALL()
+#else
+	#define GLCall(x) x
+#endif
 
 
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
+
+// Installs the debug message callback when the context supports KHR_debug.
+// Returns false if errors have to be polled with glGetError instead.
+bool GLEnableDebugOutput();
+
+struct GLCallSite
+{
+	const char* Function;
+	const char* File;
+	int Line;
+};
+
+extern GLCallSite g_GLCallSite;
+extern bool g_GLDebugOutput;
+extern bool g_GLDebugError;
+extern unsigned int g_GLCallCount;
+
+inline void GLBeginCall(const char* function, const char* file, int line)
+{
+	g_GLCallSite = { function, file, line };
+	if (!g_GLDebugOutput)
+		GLClearError();
+}
+
+inline bool GLEndCall()
+{
+	if (!g_GLDebugOutput)
+		return GLLogCall(g_GLCallSite.Function, g_GLCallSite.File, g_GLCallSite.Line);
+
+	bool ok = !g_GLDebugError;
+	g_GLDebugError = false;
+	return ok;
+}
+
+
+struct StateCacheStats
+{
+	unsigned int ProgramBinds = 0;
+	unsigned int ProgramBindsElided = 0;
+	unsigned int VertexArrayBinds = 0;
+	unsigned int VertexArrayBindsElided = 0;
+	unsigned int BufferBinds = 0;
+	unsigned int BufferBindsElided = 0;
+	unsigned int BufferRangeBinds = 0;
+	unsigned int BufferRangeBindsElided = 0;
+	unsigned int TextureBinds = 0;
+	unsigned int TextureBindsElided = 0;
+};
+
+// Remembers what is currently bound so that binding the same object again
+// doesn't reach the driver. Everything that binds or deletes programs, vertex
+// arrays, buffers or textures has to go through here or the cache goes stale
+// (call Invalidate() after touching GL state directly).
+class StateCache
+{
+public:
+	static constexpr unsigned int MaxTextureUnits = 32;
+	static constexpr unsigned int MaxBufferBindings = 16;  // indexed uniform/storage bindings tracked
+	static constexpr unsigned int Unknown = 0xFFFFFFFF;
+private:
+	unsigned int m_Program;
+	unsigned int m_ProgramPipeline;
+	unsigned int m_VertexArray;
+	unsigned int m_ArrayBuffer;
+	unsigned int m_DrawIndirectBuffer;
+	unsigned int m_DispatchIndirectBuffer;
+	// element buffer binding is part of the vertex array state
+	std::unordered_map<unsigned int, unsigned int> m_ElementBuffers;
+	unsigned int m_ActiveTextureUnit;
+	unsigned int m_TextureTargets[MaxTextureUnits];
+	unsigned int m_Textures[MaxTextureUnits];
+
+	struct BufferRange
+	{
+		unsigned int Buffer;
+		unsigned int Offset;
+		unsigned int Size;
+	};
+	BufferRange m_UniformBuffers[MaxBufferBindings];
+	BufferRange m_StorageBuffers[MaxBufferBindings];
+
+	StateCacheStats m_Stats;
+public:
+	StateCache();
+
+	void UseProgram(unsigned int program);
+	// a program in use overrides the pipeline, so this leaves none in use
+	void BindProgramPipeline(unsigned int pipeline);
+	void BindVertexArray(unsigned int vertexArray);
+	void BindBuffer(unsigned int target, unsigned int buffer);
+	void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+	// for glTexParameter etc. on a texture bound with BindTexture, which may
+	// have left another unit active
+	void ActiveTexture(unsigned int unit);
+	// glVertexArrayElementBuffer, attaches the index buffer without binding the vertex array
+	void SetElementBuffer(unsigned int vertexArray, unsigned int buffer);
+	// glBindBufferRange for GL_UNIFORM_BUFFER / GL_SHADER_STORAGE_BUFFER binding points
+	void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size);
+
+	void DeleteProgram(unsigned int program);
+	void DeleteProgramPipeline(unsigned int pipeline);
+	void DeleteVertexArray(unsigned int vertexArray);
+	void DeleteBuffer(unsigned int buffer);
+	void DeleteTexture(unsigned int texture);
+
+	void Invalidate();
+
+	inline const StateCacheStats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = StateCacheStats(); }
+};
+
+
+// Counters for one frame, see Renderer::EndFrame().
+struct RendererStats
+{
+	unsigned int DrawCalls = 0;
+	unsigned int Indices = 0;         // summed over all instances
+	unsigned int Instances = 0;
+	unsigned int Dispatches = 0;
+	StateCacheStats Binds;
+	unsigned int UniformUploads = 0;
+	uint64_t BytesUploaded = 0;       // glBufferData / glBufferSubData
+	uint64_t BytesStreamed = 0;       // written into persistently mapped StreamBuffers
+	unsigned int GLCalls = 0;         // calls made through GLCall, 0 unless GL_COUNT_CALLS
+};
+
+// Layout glDispatchComputeIndirect reads from the GL_DISPATCH_INDIRECT_BUFFER.
+struct DispatchIndirectCommand
+{
+	unsigned int GroupsX;
+	unsigned int GroupsY;
+	unsigned int GroupsZ;
+};
+
+struct DrawCommand
+{
+	Shader* Program;
+	const VertexArray* Vertices;
+	const IndexBuffer* Indices;
+	const Material* Uniforms;
+};
+
+// Draws are queued with Submit() and issued in Flush(), sorted by a 64-bit key
+//   | program (16) | vertex array (16) | material (16) | index buffer (16) |
+// so that consecutive draws share as much state as possible.
+// Everything submitted has to stay alive until Flush().
+class Renderer
+{
+private:
+	static StateCache s_StateCache;
+	static RendererStats s_Stats;
+	static RendererStats s_FrameStats;
+	static unsigned int s_StatsFrame;
+	static unsigned int s_StatsPrintInterval;
+	static bool s_DirectStateAccess;
+
+	struct SortEntry
+	{
+		uint64_t Key;
+		unsigned int Index;
+	};
+
+	std::vector<DrawCommand> m_Queue;
+	std::vector<SortEntry> m_SortEntries;
+	std::vector<SortEntry> m_SortScratch;
+public:
+	inline static StateCache& State() { return s_StateCache; }
+
+	// Buffers and vertex arrays are created and set up with GL 4.5 direct
+	// state access when the context has it, so that doesn't disturb what is
+	// bound for drawing. SetDirectStateAccess(false) forces the bind-to-edit path.
+	static bool HasDirectStateAccess();
+	inline static void SetDirectStateAccess(bool enabled) { s_DirectStateAccess = enabled; }
+
+	inline static void CountDraw(unsigned int indexCount, unsigned int instanceCount = 1)
+	{
+		s_Stats.DrawCalls++;
+		s_Stats.Indices += indexCount * instanceCount;
+		s_Stats.Instances += instanceCount;
+	}
+	// one multi-draw; the counts are already summed over its commands
+	inline static void CountIndirectDraw(unsigned int indexCount, unsigned int instanceCount)
+	{
+		s_Stats.DrawCalls++;
+		s_Stats.Indices += indexCount;
+		s_Stats.Instances += instanceCount;
+	}
+	inline static void CountUniformUpload() { s_Stats.UniformUploads++; }
+	inline static void CountUpload(uint64_t bytes) { s_Stats.BytesUploaded += bytes; }
+	inline static void CountStreamed(uint64_t bytes) { s_Stats.BytesStreamed += bytes; }
+
+	// Closes the frame's counters: they become GetFrameStats() and counting
+	// starts again from zero. Prints them every interval frames (0 = never).
+	static void EndFrame();
+	inline static const RendererStats& GetFrameStats() { return s_FrameStats; }
+	inline static void SetStatsPrintInterval(unsigned int frames) { s_StatsPrintInterval = frames; }
+	static void PrintStats(const RendererStats& stats);
+
+	void Clear() const;
+	// GL_LESS against the bound framebuffer's depth, writing it too
+	void SetDepthTest(bool enabled) const;
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	void DrawElementsInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+	// separable stages, see ProgramPipeline; pending stage programs skip the draw
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const ProgramPipeline& pipeline) const;
+	void DrawElementsInstanced(const VertexArray& va, const IndexBuffer& ib, const ProgramPipeline& pipeline, unsigned int instanceCount) const;
+
+	// Compute. Counts are work groups, see Shader::GetWorkGroupSize().
+	static void Dispatch(Shader& shader, unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1);
+	// reads a DispatchIndirectCommand at offset in buffer, e.g. written by an earlier dispatch
+	static void DispatchIndirect(Shader& shader, unsigned int buffer, unsigned int offset = 0);
+
+	// Shader writes to buffers and images (stores, atomics) are not ordered
+	// with later reads of the data. Before consuming them, wait with the
+	// barrier that matches how the data is read next (GL_*_BARRIER_BIT).
+	static void Barrier(unsigned int barriers);
+	// next read by shader storage blocks / image loads / texture sampling
+	inline static void StorageBarrier() { Barrier(GL_SHADER_STORAGE_BARRIER_BIT); }
+	inline static void ImageBarrier() { Barrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT); }
+	inline static void TextureBarrier() { Barrier(GL_TEXTURE_FETCH_BARRIER_BIT); }
+	// next read as indirect draw/dispatch arguments
+	inline static void CommandBarrier() { Barrier(GL_COMMAND_BARRIER_BIT); }
+	// next read as vertex attributes or indices
+	inline static void VertexBarrier() { Barrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT); }
+	// next read by the CPU (glGetBufferSubData, mapping)
+	inline static void BufferReadBarrier() { Barrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT); }
+
+	void Submit(Shader& shader, const VertexArray& va, const IndexBuffer& ib, const Material* material = nullptr);
+	void Flush();
+private:
+	static uint64_t MakeSortKey(const DrawCommand& command);
+	void SortQueue();
+};
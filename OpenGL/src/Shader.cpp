@@ -1,129 +1,622 @@
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 
 #include "Renderer.h"
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "ProgramPipeline.h"
+#include "Profiler.h"
 
 
-Shader::Shader(const std::string& filepath)
-	: m_Filepath(filepath), m_RendererID(0)
+struct UniformRegistry
+{
+    std::unordered_map<std::string, unsigned int> Slots;
+    std::vector<std::string> Names;
+};
+
+static UniformRegistry& GetUniformRegistry()
+{
+    // function local so handles can be created during static initialization
+    static UniformRegistry registry;
+    return registry;
+}
+
+UniformHandle::UniformHandle(const std::string& name)
+{
+    UniformRegistry& registry = GetUniformRegistry();
+    auto it = registry.Slots.find(name);
+    if (it == registry.Slots.end())
+    {
+        it = registry.Slots.emplace(name, (unsigned int)registry.Names.size()).first;
+        registry.Names.push_back(name);
+    }
+    m_Slot = it->second;
+}
 
+const std::string& UniformHandle::GetName() const
 {
+    return GetUniformRegistry().Names[m_Slot];
+}
+
+// KHR_parallel_shader_compile: linking returns immediately and
+// GL_COMPLETION_STATUS_KHR can be polled without blocking
+static bool s_ParallelCompile = false;
+
+static void EnableParallelCompile()
+{
+    static bool initialized = false;
+    if (initialized)
+        return;
+    initialized = true;
+
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+        s_ParallelCompile = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+        s_ParallelCompile = true;
+    }
+}
+
+Shader::Shader(const std::string& filepath, bool async)
+    : Shader(filepath, ShaderDefines(), async)
+{
+}
+
+Shader::Shader(const std::string& filepath, const ShaderDefines& defines, bool async)
     // VS debug-modessa suhteellinen polku
-    ShaderProgramSource source = ParseShader(filepath); 
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+    : Shader(filepath, defines, ShaderParser::Parse(filepath, defines), async)
+{
+}
+
+Shader::Shader(const std::string& filepath, const ShaderDefines& defines, const ShaderProgramSource& source, bool async, bool separable)
+	: m_Filepath(filepath), m_Defines(defines), m_SourceKey(0), m_Separable(separable), m_Program(std::make_shared<LinkedProgram>()),
+      m_DeferUniforms(false), m_Status(ShaderStatus::Pending)
+
+{
+    PROFILE_SCOPE("Shader::Shader");
+
+    m_Program->Separable = separable;
+    m_Program->PrimitiveType = GL_TRIANGLES;
+    BeginBuild(source);
+    if (!async)
+        Wait();
+}
 
+Shader::Shader(const std::string& filepath, const ShaderDefines& defines, const ShaderProgramSource& source, const Shader& shader)
+    : m_Filepath(filepath), m_Defines(defines), m_Includes(source.Includes), m_SourceKey(shader.m_Program->SourceKey),
+      m_Separable(shader.m_Separable), m_Program(shader.m_Program), m_DeferUniforms(shader.m_DeferUniforms), m_Status(ShaderStatus::Ready)
+{
+    ASSERT(m_Program->RendererID != 0);
 }
 
 Shader::~Shader()
 {
-    GLCall(glDeleteProgram(m_RendererID));
+    DiscardBuild();
+}
+
+Shader::LinkedProgram::~LinkedProgram()
+{
+    if (!RendererID)
+        return;
+    // pipelines with the program go, ProgramPipeline::Bind makes new ones
+    if (Separable)
+        ProgramPipeline::ReleaseProgram(RendererID);
+    Renderer::State().DeleteProgram(RendererID);
+}
+
+void Shader::Reload()
+{
+    PROFILE_SCOPE("Shader::Reload");
+
+    // an unfinished earlier reload is of an older version of the file
+    DiscardBuild();
+    BeginBuild(ShaderParser::Parse(m_Filepath, m_Defines));
 }
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    Renderer::State().UseProgram(m_Program->RendererID);
 }
 	
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    Renderer::State().UseProgram(0);
 }
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
-    GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+    const float values[] = { v0, v1, v2, v3 };
+    SetUniform(GetUniformLocation(name), GL_FLOAT_VEC4, values);
+}
+
+void Shader::SetUniform4f(const UniformHandle& uniform, float v0, float v1, float v2, float v3)
+{
+    const UniformSlot& slot = GetUniformSlot(uniform);
+#ifndef NDEBUG
+    ASSERT(CheckUniformType(uniform, slot, GL_FLOAT_VEC4));
+#endif
+    const float values[] = { v0, v1, v2, v3 };
+    SetUniform(slot.Location, GL_FLOAT_VEC4, values);
+}
+
+static ShaderResource* FindResource(std::vector<ShaderResource>& resources, const std::string& name)
+{
+    auto it = std::lower_bound(resources.begin(), resources.end(), name,
+        [](const ShaderResource& resource, const std::string& key) { return resource.Name < key; });
+    return it != resources.end() && it->Name == name ? &*it : nullptr;
+}
+
+void Shader::SetUniformBlockBinding(const std::string& name, unsigned int bindingPoint)
+{
+    Wait();
+    ShaderResource* block = FindResource(m_Program->UniformBlocks, name);
+    if (!block)
+    {
+        std::cout << "Warning: Uniform block '" << name << "' doesn't exist!" << std::endl;
+        return;
+    }
+    GLCall(unsigned int index = glGetProgramResourceIndex(m_Program->RendererID, GL_UNIFORM_BLOCK, name.c_str()));
+    GLCall(glUniformBlockBinding(m_Program->RendererID, index, bindingPoint));
+    block->Binding = bindingPoint;
+    m_Program->UniformBlockBindings[name] = bindingPoint;
+}
+
+void Shader::SetStorageBlockBinding(const std::string& name, unsigned int bindingPoint)
+{
+    Wait();
+    ShaderResource* block = FindResource(m_Program->StorageBlocks, name);
+    if (!block)
+    {
+        std::cout << "Warning: Storage block '" << name << "' doesn't exist!" << std::endl;
+        return;
+    }
+    GLCall(unsigned int index = glGetProgramResourceIndex(m_Program->RendererID, GL_SHADER_STORAGE_BLOCK, name.c_str()));
+    GLCall(glShaderStorageBlockBinding(m_Program->RendererID, index, bindingPoint));
+    block->Binding = bindingPoint;
+    m_Program->StorageBlockBindings[name] = bindingPoint;
+}
+
+static unsigned int GetUniformComponentCount(unsigned int type)
+{
+    switch (type)
+    {
+        case GL_FLOAT_VEC4:     return 4;
+    }
+    ASSERT(false);
+    return 0;
+}
+
+void Shader::SetUniform(int location, unsigned int type, const float* data)
+{
+    if (location < 0)
+        return;
+
+    // array elements past the reflected range aren't shadowed
+    if ((unsigned int)location >= m_Program->UniformValues.size())
+    {
+        UploadUniform(location, type, data);
+        return;
+    }
+
+    UniformValue& value = m_Program->UniformValues[location];
+    const size_t size = GetUniformComponentCount(type) * sizeof(float);
+    if (value.Valid && value.Type == type && memcmp(value.Data, data, size) == 0)
+        return;
+
+    memcpy(value.Data, data, size);
+    value.Type = type;
+    value.Valid = true;
+
+    if (m_DeferUniforms)
+    {
+        if (!value.Dirty)
+        {
+            value.Dirty = true;
+            m_Program->DirtyUniforms.push_back(location);
+        }
+        return;
+    }
+    UploadUniform(location, type, data);
+}
+
+void Shader::UploadUniform(int location, unsigned int type, const float* data)
+{
+    switch (type)
+    {
+        case GL_FLOAT_VEC4:
+            GLCall(glProgramUniform4fv(m_Program->RendererID, location, 1, data));
+            break;
+    }
+    Renderer::CountUniformUpload();
+}
+
+void Shader::FlushUniforms()
+{
+    for (int location : m_Program->DirtyUniforms)
+    {
+        UniformValue& value = m_Program->UniformValues[location];
+        UploadUniform(location, value.Type, value.Data);
+        value.Dirty = false;
+    }
+    m_Program->DirtyUniforms.clear();
+}
+
+const ShaderResource* Shader::FindUniform(const std::string& name) const
+{
+    size_t length = name.size();
+    if (length > 3 && name.compare(length - 3, 3, "[0]") == 0)
+        length -= 3;
+
+    auto it = std::lower_bound(m_Program->Uniforms.begin(), m_Program->Uniforms.end(), name,
+        [length](const ShaderResource& resource, const std::string& key)
+        {
+            return resource.Name.compare(0, std::string::npos, key, 0, length) < 0;
+        });
+    if (it != m_Program->Uniforms.end() && it->Name.compare(0, std::string::npos, name, 0, length) == 0)
+        return &*it;
+    return nullptr;
 }
 
 int Shader::GetUniformLocation(const std::string& name)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
-    GLCall(int location= glGetUniformLocation(m_RendererID, name.c_str()));
+    if (m_Status == ShaderStatus::Pending)
+        Wait();
+    if (m_Program->RendererID == 0)
+        return -1;
+
+    if (const ShaderResource* uniform = FindUniform(name))
+        return uniform->Location;
+
+    auto it = m_Program->UniformLocationCache.find(name);
+    if (it != m_Program->UniformLocationCache.end())
+        return it->second;
+    GLCall(int location= glGetUniformLocation(m_Program->RendererID, name.c_str()));
     if (location == -1)
         std::cout << "Warning: Uniform '" << name << "' doesn't exist!" << std::endl;
-    m_UniformLocationCache[name] = location;
+    m_Program->UniformLocationCache.emplace(name, location);
     return location;
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+const Shader::UniformSlot& Shader::ResolveUniformHandle(const UniformHandle& uniform)
 {
-    std::ifstream stream(filepath);
+    const unsigned int slot = uniform.GetSlot();
+    int location = GetUniformLocation(uniform.GetName());
+    const ShaderResource* resource = FindUniform(uniform.GetName());
 
-    enum class ShaderType
-    {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
-    };
+    if (slot >= m_Program->HandleUniforms.size())
+        m_Program->HandleUniforms.resize(slot + 1, { UnresolvedLocation, 0 });
+    m_Program->HandleUniforms[slot] = { location, resource ? resource->Type : 0 };
+    return m_Program->HandleUniforms[slot];
+}
 
-    std::string line;
-    std::stringstream ss[2];  // vertexille ja fragmentille omat streamit
-    ShaderType type = ShaderType::NONE;
+bool Shader::CheckUniformType(const UniformHandle& uniform, const UniformSlot& slot, unsigned int type) const
+{
+    // unknown type (array element or missing uniform) isn't an error here
+    if (slot.Type == 0 || slot.Type == type)
+        return true;
+    std::cout << "Uniform '" << uniform.GetName() << "' in " << m_Filepath << " has type 0x" <<
+        std::hex << slot.Type << ", set as 0x" << type << std::dec << std::endl;
+    return false;
+}
+
+static std::vector<ShaderResource> QueryResources(unsigned int program, GLenum programInterface)
+{
+    const bool isBlock = programInterface == GL_UNIFORM_BLOCK || programInterface == GL_SHADER_STORAGE_BLOCK;
+
+    int count = 0, maxNameLength = 0;
+    GLCall(glGetProgramInterfaceiv(program, programInterface, GL_ACTIVE_RESOURCES, &count));
+    GLCall(glGetProgramInterfaceiv(program, programInterface, GL_MAX_NAME_LENGTH, &maxNameLength));
+
+    std::vector<ShaderResource> resources;
+    resources.reserve(count);
+    std::string name(maxNameLength, '\0');
 
-    while (getline(stream, line))
+    for (int i = 0; i < count; i++)
     {
-        if (line.find("#shader") != std::string::npos)  // npos = invalid string position
+        ShaderResource resource = { "", -1, 0, 0, -1 };
+        if (isBlock)
         {
-            if (line.find("vertex") != std::string::npos)
-                type = ShaderType::VERTEX;
-            else if (line.find("fragment") != std::string::npos)
-                type = ShaderType::FRAGMENT;
+            const GLenum props[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+            int values[2];
+            GLCall(glGetProgramResourceiv(program, programInterface, i, 2, props, 2, nullptr, values));
+            resource.Binding = values[0];
+            resource.Size = values[1];
         }
         else
         {
-            ss[(int)type] << line << '\n';
+            const GLenum props[] = { GL_TYPE, GL_ARRAY_SIZE, GL_LOCATION };
+            int values[3];
+            GLCall(glGetProgramResourceiv(program, programInterface, i, 3, props, 3, nullptr, values));
+            // members of uniform blocks have no location and are set through the buffer
+            if (values[2] == -1)
+                continue;
+            resource.Type = values[0];
+            resource.Size = values[1];
+            resource.Location = values[2];
         }
+
+        int length = 0;
+        GLCall(glGetProgramResourceName(program, programInterface, i, maxNameLength, &length, &name[0]));
+        resource.Name.assign(name.data(), length);
+        if (length > 3 && resource.Name.compare(length - 3, 3, "[0]") == 0)
+            resource.Name.resize(length - 3);
+
+        resources.push_back(std::move(resource));
     }
 
-    return { ss[0].str(), ss[1].str() };
+    std::sort(resources.begin(), resources.end(),
+        [](const ShaderResource& a, const ShaderResource& b) { return a.Name < b.Name; });
+    return resources;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+void Shader::Reflect()
 {
-    GLCall(unsigned int program = glCreateProgram());
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    m_Program->Uniforms = QueryResources(m_Program->RendererID, GL_UNIFORM);
+    m_Program->UniformBlocks = QueryResources(m_Program->RendererID, GL_UNIFORM_BLOCK);
+    m_Program->StorageBlocks = QueryResources(m_Program->RendererID, GL_SHADER_STORAGE_BLOCK);
+    m_Program->Attributes = QueryResources(m_Program->RendererID, GL_PROGRAM_INPUT);
 
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    glValidateProgram(program);
+    // asking a program without a compute stage is an error
+    int workGroupSize[3] = {};
+    if (m_Build.Compute)
+    {
+        GLCall(glGetProgramiv(m_Program->RendererID, GL_COMPUTE_WORK_GROUP_SIZE, workGroupSize));
+    }
+    for (int i = 0; i < 3; i++)
+        m_Program->WorkGroupSize[i] = workGroupSize[i];
+
+    int locationCount = 0;
+    for (const ShaderResource& uniform : m_Program->Uniforms)
+        locationCount = std::max(locationCount, uniform.Location + uniform.Size);
+    m_Program->UniformValues.assign(locationCount, UniformValue());
+    m_Program->DirtyUniforms.clear();
+}
+
+static unsigned int GetStageBit(unsigned int type)
+{
+    switch (type)
+    {
+        case GL_VERTEX_SHADER: return GL_VERTEX_SHADER_BIT;
+        case GL_TESS_CONTROL_SHADER: return GL_TESS_CONTROL_SHADER_BIT;
+        case GL_TESS_EVALUATION_SHADER: return GL_TESS_EVALUATION_SHADER_BIT;
+        case GL_GEOMETRY_SHADER: return GL_GEOMETRY_SHADER_BIT;
+        case GL_FRAGMENT_SHADER: return GL_FRAGMENT_SHADER_BIT;
+        case GL_COMPUTE_SHADER: return GL_COMPUTE_SHADER_BIT;
+    }
+    return 0;
+}
+
+void Shader::BeginBuild(const ShaderProgramSource& source)
+{
+    EnableParallelCompile();
+
+    m_Build = ProgramBuild();
+    // a reload keeps drawing with the current program meanwhile
+    if (!m_Program->RendererID)
+        m_Status = ShaderStatus::Pending;
+    GLCall(m_Build.Program = glCreateProgram());
+    // has to be set before linking, or before loading a cached binary
+    if (m_Separable)
+    {
+        GLCall(glProgramParameteri(m_Build.Program, GL_PROGRAM_SEPARABLE, GL_TRUE));
+    }
+
+    m_Includes = source.Includes;
+    m_Build.Compute = source.FindStage(GL_COMPUTE_SHADER) != nullptr;
+    m_Build.PrimitiveType = source.FindStage(GL_TESS_CONTROL_SHADER) || source.FindStage(GL_TESS_EVALUATION_SHADER) ?
+        GL_PATCHES : GL_TRIANGLES;
+    for (const ShaderStageSource& stage : source.Stages)
+        m_Build.StageBits |= GetStageBit(stage.Type);
+
+    // sama ohjelma on jo linkitetty aiemmalla ajokerralla
+    m_Build.CacheKey = ShaderCache::ComputeKey(source, m_Separable);
+    m_SourceKey = m_Build.CacheKey;
+    if (ShaderCache::Load(m_Build.CacheKey, m_Build.Program))
+    {
+        m_Build.FromCache = true;
+        FinishBuild();
+        return;
+    }
+
+    // every section is its own shader object, the linker checks that the stages fit
+    for (const ShaderStageSource& stage : source.Stages)
+        m_Build.Shaders.push_back(CompileShader(stage));
+
+    for (unsigned int shader : m_Build.Shaders)
+        glAttachShader(m_Build.Program, shader);
+    glProgramParameteri(m_Build.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    // ei odoteta tulosta, status tarkistetaan vasta FinishBuildissa
+    glLinkProgram(m_Build.Program);
+}
+
+ShaderStatus Shader::PollBuild()
+{
+    if (s_ParallelCompile)
+    {
+        int completed;
+        GLCall(glGetProgramiv(m_Build.Program, GL_COMPLETION_STATUS_KHR, &completed));
+        if (completed == GL_FALSE)
+            return m_Status;
+    }
+    FinishBuild();
+    return m_Status;
+}
+
+ShaderStatus Shader::Wait()
+{
+    if (m_Build.Program)
+        FinishBuild();
+    return m_Status;
+}
+
+void Shader::DiscardBuild()
+{
+    if (!m_Build.Program)
+        return;
+
+    for (unsigned int shader : m_Build.Shaders)
+        glDeleteShader(shader);
+    Renderer::State().DeleteProgram(m_Build.Program);
+    m_Build = ProgramBuild();
+}
+
+void Shader::FinishBuild()
+{
+    PROFILE_SCOPE("Shader::FinishBuild");
+
+    unsigned int program = m_Build.Program;
+
+    int linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    bool compiled = true;
+    for (unsigned int shader : m_Build.Shaders)
+        compiled &= CheckCompileStatus(shader);
+
+    if (linked == GL_FALSE && compiled)
+    {
+        int length;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string message(length, '\0');
+        glGetProgramInfoLog(program, length, &length, &message[0]);
+        std::cout << "Failed to link " << m_Filepath << "!" << std::endl;
+        std::cout << message << std::endl;
+    }
 
     // Voidaan tuhota, koska nm on jo linkitetty ohjelmaan
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    for (unsigned int shader : m_Build.Shaders)
+    {
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+    }
+
+    if (linked == GL_FALSE)
+    {
+        Renderer::State().DeleteProgram(program);
+        m_Build = ProgramBuild();
+        // a failed reload keeps the working program
+        if (!m_Program->RendererID)
+            m_Status = ShaderStatus::Failed;
+        return;
+    }
 
-    return program;
+    glValidateProgram(program);
+    if (!m_Build.FromCache)
+        ShaderCache::Store(m_Build.CacheKey, program);
+
+    // a new program rather than changing the old one, other shaders may still share that;
+    // the old one is deleted with its last user
+    const std::shared_ptr<LinkedProgram> previous = std::move(m_Program);
+    const bool reloaded = previous->RendererID != 0;
+    m_Program = std::make_shared<LinkedProgram>();
+    m_Program->RendererID = program;
+    m_Program->Separable = m_Separable;
+    m_Program->SourceKey = m_Build.CacheKey;
+    m_Program->PrimitiveType = m_Build.PrimitiveType;
+    m_Program->StageBits = m_Build.StageBits;
+    m_Program->UniformBlockBindings = previous->UniformBlockBindings;
+    m_Program->StorageBlockBindings = previous->StorageBlockBindings;
+    Reflect();
+
+    m_Build = ProgramBuild();
+    m_Status = ShaderStatus::Ready;
+
+    if (reloaded)
+    {
+        RestoreState(*previous);
+        std::cout << "Reloaded " << m_Filepath << std::endl;
+    }
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+// Sets what the replaced program had on the new one. Uniforms are matched by
+// name and type, so ones the edit removed or retyped are left at their defaults.
+void Shader::RestoreState(const LinkedProgram& previous)
 {
-    unsigned int id = glCreateShader(type);
-    const char* src = source.c_str();  // palauttaa pointterin sourcen alkuun. sourcen on oltava olemassa!
+    const std::vector<UniformValue>& values = previous.UniformValues;
+    for (const ShaderResource& uniform : previous.Uniforms)
+    {
+        const ShaderResource* current = FindUniform(uniform.Name);
+        if (!current)
+            continue;
+
+        for (int i = 0; i < uniform.Size && i < current->Size; i++)
+        {
+            const unsigned int location = uniform.Location + i;
+            if (location < values.size() && values[location].Valid && values[location].Type == current->Type)
+                SetUniform(current->Location + i, current->Type, values[location].Data);
+        }
+    }
+
+    for (const auto& binding : previous.UniformBlockBindings)
+    {
+        if (FindResource(m_Program->UniformBlocks, binding.first))
+            SetUniformBlockBinding(binding.first, binding.second);
+    }
+    for (const auto& binding : previous.StorageBlockBindings)
+    {
+        if (FindResource(m_Program->StorageBlocks, binding.first))
+            SetStorageBlockBinding(binding.first, binding.second);
+    }
+}
+
+unsigned int Shader::CompileShader(const ShaderStageSource& stage)
+{
+    unsigned int id = glCreateShader(stage.Type);
+
+    // the pieces aren't null-terminated, they point into the middle of the files
+    std::vector<const char*> sources(stage.Pieces.size());
+    std::vector<int> lengths(stage.Pieces.size());
+    for (size_t i = 0; i < stage.Pieces.size(); i++)
+    {
+        sources[i] = stage.Pieces[i].data();
+        lengths[i] = (int)stage.Pieces[i].size();
+    }
 
     // shader,  montakoo sorsaa, sorsan pointterin muistiosoite, pituus (jos null, niin oletetaan ett on null-terminated)
-    glShaderSource(id, 1, &src, nullptr); // mrittelee shaderin lhteen
+    glShaderSource(id, (int)sources.size(), sources.data(), lengths.data()); // mrittelee shaderin lhteen
 
     glCompileShader(id);
+    return id;
+}
 
+static const char* GetStageName(int type)
+{
+    switch (type)
+    {
+        case GL_VERTEX_SHADER: return "vertex";
+        case GL_TESS_CONTROL_SHADER: return "tessellation control";
+        case GL_TESS_EVALUATION_SHADER: return "tessellation evaluation";
+        case GL_GEOMETRY_SHADER: return "geometry";
+        case GL_FRAGMENT_SHADER: return "fragment";
+        case GL_COMPUTE_SHADER: return "compute";
+    }
+    return "unknown";
+}
+
+bool Shader::CheckCompileStatus(unsigned int id)
+{
     int result;
 
     // i = id, v=vektori
     glGetShaderiv(id, GL_COMPILE_STATUS, &result);  // palauttaa shaderin statuksen resulttiin
     if (result == GL_FALSE)
     {
+        int type;
+        glGetShaderiv(id, GL_SHADER_TYPE, &type);
+
         int length;
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)_malloca(length * sizeof(char));
-        glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile " <<
-            (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
-            << " shader!" << std::endl;
+        std::string message(length, '\0');
+        glGetShaderInfoLog(id, length, &length, &message[0]);
+        std::cout << "Failed to compile " << GetStageName(type) << " shader!" << std::endl;
         std::cout << message << std::endl;
-
-        glDeleteShader(id);
-        return 0;
+        return false;
     }
-    return id;
+    return true;
 }
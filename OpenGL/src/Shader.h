@@ -1,33 +1,211 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "ShaderParser.h"
 
-struct ShaderProgramSource
+
+// Uniform name registered once in a process-wide table. Every Shader keeps
+// its locations in an array indexed by the handle's slot, so setting a
+// uniform through a handle does no string building or hashing.
+// Create handles up front (e.g. as statics), not every frame.
+class UniformHandle
 {
-	std::string VertexSource;
-	std::string FragmentSource;
+private:
+	unsigned int m_Slot;
+public:
+	explicit UniformHandle(const std::string& name);
+
+	inline unsigned int GetSlot() const { return m_Slot; }
+	const std::string& GetName() const;
 };
 
 
+// Active uniform, attribute or buffer block of a linked program.
+struct ShaderResource
+{
+	std::string Name;   // arrays without the "[0]" suffix
+	int Location;       // -1 for blocks
+	unsigned int Type;  // GL_FLOAT_VEC4 etc., 0 for blocks
+	int Size;           // array length, or buffer size in bytes for blocks
+	int Binding;        // block binding point, -1 for uniforms and attributes
+};
+
+
+enum class ShaderStatus
+{
+	Pending, Ready, Failed
+};
+
+// With async = true the constructor only submits the sources to the driver.
+// The program is used once GetStatus() reports Ready; where the driver
+// supports KHR_parallel_shader_compile that never blocks.
+//
+// Reload() builds the file again the same way while the current program
+// stays in use. The new one replaces it in GetStatus() once it has linked,
+// keeping the uniform values and block bindings that were set; a reload
+// that fails to build leaves the old program in place.
+//
+// A separable shader is linked with GL_PROGRAM_SEPARABLE and is drawn as
+// part of a ProgramPipeline, whose other stages come from other shaders.
+//
+// Shaders of different files with the same source can share one linked
+// program, together with its uniform values (ShaderLibrary does that). Each
+// keeps its own file; reloading one gives it a program of its own.
 class Shader
 {
 private:
+	struct UniformSlot
+	{
+		int Location;
+		unsigned int Type;
+	};
+	// last value set for each location, so unchanged values aren't uploaded again
+	struct UniformValue
+	{
+		float Data[16];  // big enough for a mat4
+		unsigned int Type = 0;
+		bool Valid = false;
+		bool Dirty = false;
+	};
+	// the GL program and everything that belongs to it, deleted with its last shader
+	struct LinkedProgram
+	{
+		unsigned int RendererID = 0;
+		bool Separable = false;
+		uint64_t SourceKey = 0;  // of the source it was linked from
+
+		// reflected right after linking, each table sorted by name
+		std::vector<ShaderResource> Uniforms;
+		std::vector<ShaderResource> UniformBlocks;
+		std::vector<ShaderResource> StorageBlocks;
+		std::vector<ShaderResource> Attributes;
+		// array elements and names that aren't active uniforms
+		std::unordered_map<std::string, int> UniformLocationCache;
+		// bindings changed with Set*BlockBinding, applied again after a reload
+		std::unordered_map<std::string, unsigned int> UniformBlockBindings;
+		std::unordered_map<std::string, unsigned int> StorageBlockBindings;
+
+		std::vector<UniformSlot> HandleUniforms;  // indexed by UniformHandle slot
+		std::vector<UniformValue> UniformValues;  // indexed by location
+		std::vector<int> DirtyUniforms;
+
+		unsigned int PrimitiveType = 0;
+		unsigned int StageBits = 0;
+		unsigned int WorkGroupSize[3] = {};  // zero unless compute
+
+		~LinkedProgram();
+	};
+
 	std::string m_Filepath;
-	unsigned int m_RendererID;
-	std::unordered_map<std::string, unsigned int> m_UniformLocationCache;
+	ShaderDefines m_Defines;
+	std::vector<std::string> m_Includes;  // of the last parse
+	uint64_t m_SourceKey;                 // ShaderCache::ComputeKey of the last build's source
+	bool m_Separable;
+	std::shared_ptr<LinkedProgram> m_Program;
+	bool m_DeferUniforms;
+
+	// program still being compiled/linked, replaces m_Program when done
+	struct ProgramBuild
+	{
+		unsigned int Program = 0;
+		std::vector<unsigned int> Shaders;
+		uint64_t CacheKey = 0;
+		bool FromCache = false;
+		bool Compute = false;
+		unsigned int PrimitiveType = 0;
+		unsigned int StageBits = 0;
+	};
+	ProgramBuild m_Build;
+	ShaderStatus m_Status;
 public:
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, bool async = false);
+	// a variant of the file, see ShaderLibrary for sharing them
+	Shader(const std::string& filepath, const ShaderDefines& defines, bool async = false);
+	// source is what ShaderParser::Parse(filepath, defines) returned
+	Shader(const std::string& filepath, const ShaderDefines& defines, const ShaderProgramSource& source, bool async = false, bool separable = false);
+	// Uses the linked program of shader, which has to be ready and built from
+	// the same source, instead of building one.
+	Shader(const std::string& filepath, const ShaderDefines& defines, const ShaderProgramSource& source, const Shader& shader);
 	~Shader();
 
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+
 	void Bind() const;
 	void Unbind() const;
 
+	inline ShaderStatus GetStatus() { return m_Build.Program ? PollBuild() : m_Status; }
+	inline bool IsReady() { return GetStatus() == ShaderStatus::Ready; }
+	// blocks until a pending build has finished
+	ShaderStatus Wait();
+	// starts building the file again, see above
+	void Reload();
+	inline bool IsReloading() const { return m_Build.Program != 0 && m_Program->RendererID != 0; }
+
+	inline const std::string& GetFilepath() const { return m_Filepath; }
+	inline const ShaderDefines& GetDefines() const { return m_Defines; }
+	// files the source #includes, a reload has to follow them too
+	inline const std::vector<std::string>& GetIncludes() const { return m_Includes; }
+	// ShaderCache::ComputeKey of what the last build (or reload) started from
+	inline uint64_t GetSourceKey() const { return m_SourceKey; }
+	// has a linked program of that source, which another shader can use
+	inline bool HasProgramFor(uint64_t sourceKey) const { return m_Program->RendererID != 0 && m_Program->SourceKey == sourceKey; }
+
+	inline unsigned int GetRendererID() const { return m_Program->RendererID; }
+	// GL_PATCHES when the program has tessellation stages, GL_TRIANGLES otherwise
+	inline unsigned int GetPrimitiveType() const { return m_Program->PrimitiveType; }
+	inline bool IsCompute() const { return m_Program->WorkGroupSize[0] != 0; }
+	inline bool IsSeparable() const { return m_Separable; }
+	// GL_VERTEX_SHADER_BIT etc. of the stages the program has
+	inline unsigned int GetStageBits() const { return m_Program->StageBits; }
+	// local_size_x/y/z of a compute program
+	inline const unsigned int* GetWorkGroupSize() const { return m_Program->WorkGroupSize; }
+
+	const ShaderResource* FindUniform(const std::string& name) const;
+	inline const std::vector<ShaderResource>& GetUniforms() const { return m_Program->Uniforms; }
+	inline const std::vector<ShaderResource>& GetUniformBlocks() const { return m_Program->UniformBlocks; }
+	inline const std::vector<ShaderResource>& GetStorageBlocks() const { return m_Program->StorageBlocks; }
+	inline const std::vector<ShaderResource>& GetAttributes() const { return m_Program->Attributes; }
+
+	// Points a named uniform / shader storage block at a buffer binding point
+	void SetUniformBlockBinding(const std::string& name, unsigned int bindingPoint);
+	void SetStorageBlockBinding(const std::string& name, unsigned int bindingPoint);
+
 	void SetUniform4f(const std::string& name, float v0, float v1, float f2, float f3);
+	void SetUniform4f(const UniformHandle& uniform, float v0, float v1, float v2, float v3);
+
+	// Deferred: setters only record the value and FlushUniforms() uploads
+	// everything that changed, e.g. right before a draw (Renderer::Flush does).
+	// Uniforms are uploaded with glProgramUniform*, so no Bind() is needed.
+	inline void SetDeferredUniforms(bool deferred) { m_DeferUniforms = deferred; }
+	void FlushUniforms();
 
 private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
+	void BeginBuild(const ShaderProgramSource& source);
+	ShaderStatus PollBuild();
+	void FinishBuild();
+	void DiscardBuild();
+	void RestoreState(const LinkedProgram& previous);
+	unsigned int CompileShader(const ShaderStageSource& stage);
+	bool CheckCompileStatus(unsigned int id);
 	int GetUniformLocation(const std::string& name);
+	inline const UniformSlot& GetUniformSlot(const UniformHandle& uniform)
+	{
+		const unsigned int slot = uniform.GetSlot();
+		const std::vector<UniformSlot>& slots = m_Program->HandleUniforms;
+		if (slot < slots.size() && slots[slot].Location != UnresolvedLocation)
+			return slots[slot];
+		return ResolveUniformHandle(uniform);
+	}
+	const UniformSlot& ResolveUniformHandle(const UniformHandle& uniform);
+	bool CheckUniformType(const UniformHandle& uniform, const UniformSlot& slot, unsigned int type) const;
+	void Reflect();
+	void SetUniform(int location, unsigned int type, const float* data);
+	void UploadUniform(int location, unsigned int type, const float* data);
+
+	static constexpr int UnresolvedLocation = -2;
 };
\ No newline at end of file
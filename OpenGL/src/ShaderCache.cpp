@@ -0,0 +1,159 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "ShaderCache.h"
+#include "Shader.h"
+#include "Renderer.h"
+
+
+static const uint32_t CacheMagic = 0x42504C47;  // "GLPB"
+static const uint32_t CacheVersion = 1;
+
+std::string ShaderCache::s_Directory = "shadercache";
+
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+    // FNV-1a
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+static uint64_t HashString(uint64_t hash, const char* string)
+{
+    // include the terminator so "ab" + "c" and "a" + "bc" differ
+    return HashBytes(hash, string ? string : "", string ? strlen(string) + 1 : 1);
+}
+
+void ShaderCache::SetDirectory(const std::string& directory)
+{
+    s_Directory = directory;
+}
+
+uint64_t ShaderCache::ComputeKey(const ShaderProgramSource& source, bool separable)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = HashBytes(hash, &CacheVersion, sizeof(CacheVersion));
+    // only hashed when set, so the keys of ordinary programs stay the same
+    if (separable)
+        hash = HashString(hash, "separable");
+    for (const ShaderStageSource& stage : source.Stages)
+    {
+        // where the pieces are split doesn't matter, only the text they make up
+        hash = HashBytes(hash, &stage.Type, sizeof(stage.Type));
+        for (std::string_view piece : stage.Pieces)
+            hash = HashBytes(hash, piece.data(), piece.size());
+        hash = HashString(hash, "");
+    }
+    hash = HashString(hash, (const char*)glGetString(GL_VENDOR));
+    hash = HashString(hash, (const char*)glGetString(GL_RENDERER));
+    hash = HashString(hash, (const char*)glGetString(GL_VERSION));
+    return hash;
+}
+
+std::string ShaderCache::GetPath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return s_Directory + "/" + name;
+}
+
+bool ShaderCache::Load(uint64_t key, unsigned int program)
+{
+    std::ifstream stream(GetPath(key), std::ios::binary | std::ios::ate);
+    if (!stream)
+        return false;
+    const std::streamoff fileSize = stream.tellg();
+    stream.seekg(0);
+
+    uint32_t header[3];  // magic, binary format, length
+    if (!stream.read((char*)header, sizeof(header)) || header[0] != CacheMagic)
+        return false;
+    // a truncated or corrupt file must not decide how much is allocated
+    if (fileSize < (std::streamoff)sizeof(header) || header[2] != (uint64_t)(fileSize - sizeof(header)))
+        return false;
+
+    std::vector<char> binary(header[2]);
+    if (!stream.read(binary.data(), binary.size()))
+        return false;
+
+    // an unknown format would raise GL_INVALID_ENUM, check it first
+    GLint formatCount = 0;
+    GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+    std::vector<GLint> formats(formatCount);
+    if (formatCount > 0)
+    {
+        GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data()));
+    }
+    if (std::find(formats.begin(), formats.end(), (GLint)header[1]) == formats.end())
+        return false;
+
+    GLCall(glProgramBinary(program, header[1], binary.data(), (GLsizei)binary.size()));
+
+    int linked;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    if (linked == GL_FALSE)
+    {
+        std::cout << "Program binary " << GetPath(key) << " is stale, rebuilding from source" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ShaderCache::Store(uint64_t key, unsigned int program)
+{
+    GLint length = 0;
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+    std::error_code error;
+    std::filesystem::create_directories(s_Directory, error);
+
+    // written under a name of its own and renamed when complete, so a crash
+    // or another instance storing the same key never leaves half a binary
+    const std::string path = GetPath(key);
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%08x.tmp", (unsigned int)std::random_device()());
+    const std::string tempPath = path + suffix;
+    {
+        std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        if (!stream)
+        {
+            std::cout << "Warning: can't write program binary " << path << std::endl;
+            return;
+        }
+
+        uint32_t header[3] = { CacheMagic, format, (uint32_t)length };
+        stream.write((const char*)header, sizeof(header));
+        stream.write(binary.data(), length);
+        stream.close();
+        if (!stream)
+        {
+            std::cout << "Warning: can't write program binary " << path << std::endl;
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        std::cout << "Warning: can't write program binary " << path << std::endl;
+        std::filesystem::remove(tempPath, error);
+    }
+}
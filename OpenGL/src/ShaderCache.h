@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct ShaderProgramSource;
+
+// On-disk cache of linked program binaries (glGetProgramBinary). Entries are
+// keyed by a hash of the shader sources and the driver's vendor, renderer and
+// version strings, so a driver update simply misses the cache.
+class ShaderCache
+{
+private:
+	static std::string s_Directory;
+public:
+	static void SetDirectory(const std::string& directory);
+	inline static const std::string& GetDirectory() { return s_Directory; }
+
+	// separable programs (GL_PROGRAM_SEPARABLE) get keys of their own
+	static uint64_t ComputeKey(const ShaderProgramSource& source, bool separable = false);
+
+	// Loads the binary into program. Returns false on a miss, or when the
+	// driver rejects the binary, in which case the program has to be built
+	// from source.
+	static bool Load(uint64_t key, unsigned int program);
+	static void Store(uint64_t key, unsigned int program);
+private:
+	static std::string GetPath(uint64_t key);
+};
@@ -0,0 +1,127 @@
+#include <filesystem>
+#include <unordered_set>
+
+#include "ShaderLibrary.h"
+#include "ShaderCache.h"
+#include "Profiler.h"
+
+
+std::unordered_map<std::string, std::shared_ptr<Shader>> ShaderLibrary::s_Variants;
+std::unordered_map<uint64_t, std::weak_ptr<Shader>> ShaderLibrary::s_Sources;
+bool ShaderLibrary::s_Async = true;
+
+std::shared_ptr<Shader> ShaderLibrary::Load(const std::string& filepath, const ShaderDefines& defines)
+{
+    return Load(filepath, defines, false);
+}
+
+std::shared_ptr<Shader> ShaderLibrary::LoadSeparable(const std::string& filepath, const ShaderDefines& defines)
+{
+    return Load(filepath, defines, true);
+}
+
+std::shared_ptr<Shader> ShaderLibrary::Load(const std::string& filepath, const ShaderDefines& defines, bool separable)
+{
+    PROFILE_SCOPE("ShaderLibrary::Load");
+
+    std::string key = GetVariantKey(filepath, defines, separable);
+    const ShaderProgramSource source = ShaderParser::Parse(filepath, defines);
+    const uint64_t sourceKey = ShaderCache::ComputeKey(source, separable);
+
+    auto it = s_Variants.find(key);
+    if (it != s_Variants.end())
+    {
+        // edited since, and no ShaderWatcher reloaded it
+        const std::shared_ptr<Shader>& shader = it->second;
+        if (shader->GetSourceKey() != sourceKey)
+        {
+            shader->Reload();
+            if (!s_Async)
+                shader->Wait();
+        }
+        return shader;
+    }
+
+    // another file with the same text already has the program
+    std::shared_ptr<Shader> shader;
+    auto same = s_Sources.find(sourceKey);
+    if (same != s_Sources.end())
+    {
+        std::shared_ptr<Shader> other = same->second.lock();
+        if (other && other->HasProgramFor(sourceKey))
+            shader = std::make_shared<Shader>(filepath, defines, source, *other);
+    }
+
+    if (!shader)
+    {
+        shader = std::make_shared<Shader>(filepath, defines, source, s_Async, separable);
+        if (!source.Stages.empty())
+            s_Sources[sourceKey] = shader;
+    }
+    s_Variants.emplace(std::move(key), shader);
+    return shader;
+}
+
+std::shared_ptr<Shader> ShaderLibrary::Find(const std::string& filepath, const ShaderDefines& defines, bool separable)
+{
+    auto it = s_Variants.find(GetVariantKey(filepath, defines, separable));
+    return it != s_Variants.end() ? it->second : nullptr;
+}
+
+unsigned int ShaderLibrary::ReleaseUnused()
+{
+    unsigned int released = 0;
+    for (auto it = s_Variants.begin(); it != s_Variants.end(); )
+    {
+        if (it->second.use_count() == 1)
+        {
+            it = s_Variants.erase(it);
+            released++;
+        }
+        else
+            ++it;
+    }
+    for (auto it = s_Sources.begin(); it != s_Sources.end(); )
+    {
+        if (it->second.expired())
+            it = s_Sources.erase(it);
+        else
+            ++it;
+    }
+    return released;
+}
+
+void ShaderLibrary::Shutdown()
+{
+    // programs still held elsewhere are deleted by their last user
+    s_Variants.clear();
+    s_Sources.clear();
+}
+
+std::vector<std::shared_ptr<Shader>> ShaderLibrary::GetShaders()
+{
+    std::vector<std::shared_ptr<Shader>> shaders;
+    shaders.reserve(s_Variants.size());
+    for (const auto& variant : s_Variants)
+        shaders.push_back(variant.second);
+    return shaders;
+}
+
+unsigned int ShaderLibrary::GetProgramCount()
+{
+    std::unordered_set<unsigned int> programs;
+    for (const auto& variant : s_Variants)
+    {
+        if (variant.second->GetRendererID())
+            programs.insert(variant.second->GetRendererID());
+    }
+    return (unsigned int)programs.size();
+}
+
+std::string ShaderLibrary::GetVariantKey(const std::string& filepath, const ShaderDefines& defines, bool separable)
+{
+    // "res/shaders/Basic.shader" and "./res/shaders/../shaders/Basic.shader" are one file
+    std::error_code error;
+    const std::filesystem::path canonical = std::filesystem::weakly_canonical(filepath, error);
+    return (error ? filepath : canonical.generic_string()) + "|" + defines.GetKey() + (separable ? "|separable" : "");
+}
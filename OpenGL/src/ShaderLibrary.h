@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+// Process-wide cache of shader programs. A variant is a file plus a
+// ShaderDefines set; every Load() of the same variant returns the same
+// Shader, so its program and uniform cache are shared by all users (values
+// that differ per object belong in a Material). Paths are made canonical
+// first.
+//
+// Each Load() hashes the parsed source too. A variant whose file changed
+// since it was built is reloaded, even without a ShaderWatcher. A new variant
+// whose source hashes the same as a loaded one, e.g. a copy of a file, gets
+// a Shader of its own (a ShaderWatcher follows each file) that uses the
+// same linked program and uniform values. Once either is edited it gets a
+// program of its own.
+//
+// Shaders are reference counted. One stays loaded until ReleaseUnused() runs
+// after its last user let go (a ShaderWatcher counts as a user), and
+// Shutdown() has to run before the context is destroyed. New programs are
+// built asynchronously unless SetAsync(false) was called, so check
+// IsReady(); the Renderer and the indirect draw paths skip programs that
+// aren't. Shader::Wait() blocks until one is built, the compute passes do
+// that when they are created.
+//
+// Load() parses the file and builds a key string, so keep the returned
+// pointer rather than loading every frame.
+//
+// LoadSeparable() gives GL_PROGRAM_SEPARABLE programs for a ProgramPipeline,
+// typically a file with a single stage. They are separate variants and never
+// share a program with Load() of the same source.
+class ShaderLibrary
+{
+private:
+	static std::unordered_map<std::string, std::shared_ptr<Shader>> s_Variants;  // by GetVariantKey()
+	// a variant built from each source, by Shader::GetSourceKey(); it may have been edited since
+	static std::unordered_map<uint64_t, std::weak_ptr<Shader>> s_Sources;
+	static bool s_Async;
+public:
+	static std::shared_ptr<Shader> Load(const std::string& filepath, const ShaderDefines& defines = ShaderDefines());
+	static std::shared_ptr<Shader> LoadSeparable(const std::string& filepath, const ShaderDefines& defines = ShaderDefines());
+	// null if the variant isn't loaded
+	static std::shared_ptr<Shader> Find(const std::string& filepath, const ShaderDefines& defines = ShaderDefines(), bool separable = false);
+
+	inline static void SetAsync(bool async) { s_Async = async; }
+
+	// Frees the programs only the library holds. Returns how many were freed.
+	static unsigned int ReleaseUnused();
+	static void Shutdown();
+
+	// every loaded variant, e.g. to hand to a ShaderWatcher
+	static std::vector<std::shared_ptr<Shader>> GetShaders();
+	// linked programs, one shared by several variants counts once
+	static unsigned int GetProgramCount();
+
+	// "canonical file|NAME=VALUE;...", "|separable" appended for separable programs
+	static std::string GetVariantKey(const std::string& filepath, const ShaderDefines& defines, bool separable = false);
+private:
+	static std::shared_ptr<Shader> Load(const std::string& filepath, const ShaderDefines& defines, bool separable);
+};
@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "ShaderParser.h"
+#include "Renderer.h"
+
+
+std::unordered_map<std::string, ShaderParser::CachedFile> ShaderParser::s_Files;
+
+struct StageKeyword
+{
+    std::string_view Name;
+    unsigned int Type;
+};
+
+static const StageKeyword StageKeywords[] = {
+    { "vertex", GL_VERTEX_SHADER },
+    { "fragment", GL_FRAGMENT_SHADER },
+    { "geometry", GL_GEOMETRY_SHADER },
+    { "tess_control", GL_TESS_CONTROL_SHADER },
+    { "tess_evaluation", GL_TESS_EVALUATION_SHADER },
+    { "compute", GL_COMPUTE_SHADER }
+};
+
+ShaderDefines::ShaderDefines(std::initializer_list<const char*> names)
+{
+    for (const char* name : names)
+        Set(name);
+}
+
+ShaderDefines& ShaderDefines::Set(const std::string& name, const std::string& value)
+{
+    auto it = std::lower_bound(m_Defines.begin(), m_Defines.end(), name,
+        [](const std::pair<std::string, std::string>& define, const std::string& key) { return define.first < key; });
+    if (it != m_Defines.end() && it->first == name)
+        it->second = value;
+    else
+        m_Defines.insert(it, { name, value });
+    return *this;
+}
+
+ShaderDefines& ShaderDefines::Set(const std::string& name, int value)
+{
+    return Set(name, std::to_string(value));
+}
+
+void ShaderDefines::Remove(const std::string& name)
+{
+    auto it = std::lower_bound(m_Defines.begin(), m_Defines.end(), name,
+        [](const std::pair<std::string, std::string>& define, const std::string& key) { return define.first < key; });
+    if (it != m_Defines.end() && it->first == name)
+        m_Defines.erase(it);
+}
+
+std::string ShaderDefines::GetKey() const
+{
+    std::string key;
+    for (const auto& define : m_Defines)
+    {
+        if (!key.empty())
+            key += ';';
+        key += define.first;
+        key += '=';
+        key += define.second;
+    }
+    return key;
+}
+
+std::string ShaderDefines::GetSource() const
+{
+    std::string source;
+    for (const auto& define : m_Defines)
+        source += "#define " + define.first + " " + define.second + "\n";
+    return source;
+}
+
+const ShaderStageSource* ShaderProgramSource::FindStage(unsigned int type) const
+{
+    for (const ShaderStageSource& stage : Stages)
+    {
+        if (stage.Type == type)
+            return &stage;
+    }
+    return nullptr;
+}
+
+static std::string_view TrimLeft(std::string_view text)
+{
+    const size_t begin = text.find_first_not_of(" \t");
+    return begin == std::string_view::npos ? std::string_view() : text.substr(begin);
+}
+
+// Returns the word text starts with and advances text past it
+static std::string_view NextWord(std::string_view& text)
+{
+    text = TrimLeft(text);
+    const std::string_view word = text.substr(0, text.find_first_of(" \t\r"));
+    text.remove_prefix(word.size());
+    return word;
+}
+
+struct ParseState
+{
+    ShaderProgramSource& Source;
+    const std::string& Defines;         // ShaderDefines::GetSource()
+    int Stage;                          // index in Source.Stages, -1 outside a stage
+    size_t StageBegin;                  // offset of the stage's first line in the main file
+    bool DefinesAdded;
+    std::vector<std::string> Included;  // by the current stage
+};
+
+static void AddPiece(ParseState& state, std::string_view piece)
+{
+    if (state.Stage >= 0 && !piece.empty())
+        state.Source.Stages[state.Stage].Pieces.push_back(piece);
+}
+
+// Puts the defines after the #version line that section (the stage's text up
+// to and including that line) ends with, and numbers the lines after them as
+// they are in the section.
+static void AddDefines(ParseState& state, std::string_view section)
+{
+    const size_t lines = std::count(section.begin(), section.end(), '\n');
+    auto text = std::make_shared<const std::string>(state.Defines + "#line " + std::to_string(lines + 1) + "\n");
+    state.Source.Files.push_back(text);
+    AddPiece(state, *text);
+    state.DefinesAdded = true;
+}
+
+// A stage without a #version line gets the defines first
+static void EndStage(ParseState& state)
+{
+    if (state.Stage < 0 || state.DefinesAdded || state.Defines.empty())
+        return;
+
+    auto text = std::make_shared<const std::string>(state.Defines);
+    state.Source.Files.push_back(text);
+    std::vector<std::string_view>& pieces = state.Source.Stages[state.Stage].Pieces;
+    pieces.insert(pieces.begin(), *text);
+}
+
+static void BeginStage(ParseState& state, std::string_view name, size_t begin)
+{
+    EndStage(state);
+    state.Included.clear();
+    state.StageBegin = begin;
+    state.DefinesAdded = false;
+    for (const StageKeyword& keyword : StageKeywords)
+    {
+        if (name == keyword.Name)
+        {
+            state.Source.Stages.push_back({ keyword.Type, {} });
+            state.Stage = (int)state.Source.Stages.size() - 1;
+            return;
+        }
+    }
+    std::cout << "Unknown shader stage '" << name << "', the section is skipped!" << std::endl;
+    state.Stage = -1;
+}
+
+static void ParseText(ParseState& state, std::string_view text, const std::filesystem::path& directory, bool isMain);
+
+static void Include(ParseState& state, std::string_view argument, const std::filesystem::path& directory)
+{
+    argument = TrimLeft(argument);
+    const char close = argument.empty() ? 0 : argument[0] == '"' ? '"' : argument[0] == '<' ? '>' : 0;
+    const size_t end = close ? argument.find(close, 1) : std::string_view::npos;
+    if (end == std::string_view::npos)
+    {
+        std::cout << "Malformed #include " << argument << std::endl;
+        return;
+    }
+    if (state.Stage < 0)
+        return;
+
+    const std::string path = (directory / argument.substr(1, end - 1)).lexically_normal().generic_string();
+    if (std::find(state.Included.begin(), state.Included.end(), path) != state.Included.end())
+        return;
+    state.Included.push_back(path);
+
+    std::shared_ptr<const std::string> file = ShaderParser::LoadFile(path);
+    if (!file)
+    {
+        std::cout << "Can't open included file " << path << "!" << std::endl;
+        return;
+    }
+    state.Source.Files.push_back(file);
+    std::vector<std::string>& includes = state.Source.Includes;
+    if (std::find(includes.begin(), includes.end(), path) == includes.end())
+        includes.push_back(path);
+
+    ParseText(state, *file, std::filesystem::path(path).parent_path(), false);
+}
+
+static void ParseText(ParseState& state, std::string_view text, const std::filesystem::path& directory, bool isMain)
+{
+    size_t pieceBegin = 0;
+    size_t lineBegin = 0;
+    while (lineBegin < text.size())
+    {
+        size_t lineEnd = text.find('\n', lineBegin);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
+
+        // only directives need a closer look
+        std::string_view line = TrimLeft(text.substr(lineBegin, lineEnd - lineBegin));
+        if (!line.empty() && line[0] == '#')
+        {
+            line.remove_prefix(1);
+            const std::string_view directive = NextWord(line);
+            if (directive == "shader" && isMain)
+            {
+                AddPiece(state, text.substr(pieceBegin, lineBegin - pieceBegin));
+                pieceBegin = std::min(lineEnd + 1, text.size());
+                BeginStage(state, NextWord(line), pieceBegin);
+            }
+            else if (directive == "version" && isMain && state.Stage >= 0 && !state.DefinesAdded && !state.Defines.empty())
+            {
+                const size_t next = std::min(lineEnd + 1, text.size());
+                AddPiece(state, text.substr(pieceBegin, next - pieceBegin));
+                AddDefines(state, text.substr(state.StageBegin, next - state.StageBegin));
+                pieceBegin = next;
+            }
+            else if (directive == "include")
+            {
+                AddPiece(state, text.substr(pieceBegin, lineBegin - pieceBegin));
+                Include(state, line, directory);
+                // keeps the directive's newline in case the included file doesn't end with one
+                pieceBegin = lineEnd;
+            }
+        }
+        lineBegin = lineEnd + 1;
+    }
+    AddPiece(state, text.substr(std::min(pieceBegin, text.size())));
+}
+
+ShaderProgramSource ShaderParser::Parse(const std::string& filepath, const ShaderDefines& defines)
+{
+    ShaderProgramSource source;
+    std::shared_ptr<const std::string> file = LoadFile(filepath);
+    if (!file)
+    {
+        std::cout << "Can't open " << filepath << "!" << std::endl;
+        return source;
+    }
+    source.Files.push_back(file);
+
+    const std::string defineSource = defines.GetSource();
+    ParseState state = { source, defineSource, -1, 0, false, {} };
+    ParseText(state, *file, std::filesystem::path(filepath).parent_path(), true);
+    EndStage(state);
+    return source;
+}
+
+std::shared_ptr<const std::string> ShaderParser::LoadFile(const std::string& filepath)
+{
+    std::error_code error;
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filepath, error);
+    if (!error)
+    {
+        auto it = s_Files.find(filepath);
+        if (it != s_Files.end() && it->second.WriteTime == writeTime)
+            return it->second.Text;
+    }
+
+    // a directory opens too, and seeking to its end gives no usable size
+    std::error_code typeError;
+    if (!std::filesystem::is_regular_file(filepath, typeError))
+        return nullptr;
+
+    std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+    if (!stream)
+        return nullptr;
+
+    const std::streamoff size = stream.tellg();
+    if (size < 0)
+        return nullptr;
+
+    std::shared_ptr<std::string> text = std::make_shared<std::string>((size_t)size, '\0');
+    stream.seekg(0);
+    if (!stream.read(&(*text)[0], text->size()))
+        return nullptr;
+
+    if (!error)
+        s_Files[filepath] = { writeTime, text };
+    return text;
+}
+
+void ShaderParser::ClearCache()
+{
+    s_Files.clear();
+}
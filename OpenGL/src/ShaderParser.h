@@ -0,0 +1,85 @@
+#pragma once
+
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+// Preprocessor defines a shader variant is built with. Kept sorted by name,
+// so the same set always gives the same key whatever order it was built in.
+class ShaderDefines
+{
+private:
+	std::vector<std::pair<std::string, std::string>> m_Defines;
+public:
+	ShaderDefines() = default;
+	// names defined as 1
+	ShaderDefines(std::initializer_list<const char*> names);
+
+	ShaderDefines& Set(const std::string& name, const std::string& value = "1");
+	ShaderDefines& Set(const std::string& name, int value);
+	void Remove(const std::string& name);
+
+	inline bool IsEmpty() const { return m_Defines.empty(); }
+	inline const std::vector<std::pair<std::string, std::string>>& GetDefines() const { return m_Defines; }
+
+	// "INSTANCED=1;LIGHT_COUNT=4"
+	std::string GetKey() const;
+	// "#define INSTANCED 1\n#define LIGHT_COUNT 4\n"
+	std::string GetSource() const;
+};
+
+
+// One "#shader <stage>" section. The source is a list of pieces pointing
+// into the loaded files, an #include splicing in the included file's text;
+// they go to glShaderSource as they are, without being joined.
+struct ShaderStageSource
+{
+	unsigned int Type;  // GL_VERTEX_SHADER etc.
+	std::vector<std::string_view> Pieces;
+};
+
+struct ShaderProgramSource
+{
+	std::vector<ShaderStageSource> Stages;  // in file order
+	// keeps the text the pieces point into alive
+	std::vector<std::shared_ptr<const std::string>> Files;
+	std::vector<std::string> Includes;      // every file included, once
+
+	const ShaderStageSource* FindStage(unsigned int type) const;
+};
+
+// Splits a .shader file into its stages in one pass over the text.
+//
+//   #shader vertex | fragment | geometry | tess_control | tess_evaluation | compute
+//   #include "common.glsl"
+//
+// Defines are inserted after each stage's #version line, followed by a #line
+// directive so compile errors still point at the right line.
+//
+// Lines before the first #shader are ignored. An include path is relative to
+// the including file, and a file is included at most once per stage, so
+// headers need no guards and cycles end. Files are read whole and kept in a
+// cache, checked against their modification time, so an include shared by
+// many shaders is read from disk once.
+class ShaderParser
+{
+private:
+	struct CachedFile
+	{
+		std::filesystem::file_time_type WriteTime;
+		std::shared_ptr<const std::string> Text;
+	};
+	static std::unordered_map<std::string, CachedFile> s_Files;
+public:
+	static ShaderProgramSource Parse(const std::string& filepath, const ShaderDefines& defines = ShaderDefines());
+
+	// null if the file can't be read
+	static std::shared_ptr<const std::string> LoadFile(const std::string& filepath);
+	static void ClearCache();
+};
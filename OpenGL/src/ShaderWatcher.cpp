@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+#include "ShaderWatcher.h"
+#include "Shader.h"
+#include "Profiler.h"
+
+
+static const std::chrono::milliseconds PollInterval(500);
+
+ShaderWatcher::ShaderWatcher()
+    : m_Notify(-1), m_LastPoll(std::chrono::steady_clock::now())
+{
+#ifdef __linux__
+    m_Notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_Notify < 0)
+        std::cout << "inotify isn't available, polling shader files instead" << std::endl;
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+#ifdef __linux__
+    // removes every watch
+    if (m_Notify >= 0)
+        close(m_Notify);
+#endif
+}
+
+void ShaderWatcher::Watch(const std::shared_ptr<Shader>& shader)
+{
+    for (const WatchedShader& watched : m_Shaders)
+    {
+        if (watched.Program == shader)
+            return;
+    }
+
+    m_Shaders.push_back({ shader, {}, false });
+    WatchFiles(m_Shaders.back());
+}
+
+void ShaderWatcher::Unwatch(const std::shared_ptr<Shader>& shader)
+{
+    auto it = std::find_if(m_Shaders.begin(), m_Shaders.end(),
+        [&shader](const WatchedShader& watched) { return watched.Program == shader; });
+    if (it == m_Shaders.end())
+        return;
+
+    std::vector<WatchedFile> files = std::move(it->Files);
+    m_Shaders.erase(it);
+    for (const WatchedFile& file : files)
+        ReleaseWatch(file.WatchDescriptor);
+}
+
+void ShaderWatcher::WatchFiles(WatchedShader& watched)
+{
+    std::vector<WatchedFile> previous = std::move(watched.Files);
+
+    watched.Files.clear();
+    watched.Files.push_back(WatchFile(watched.Program->GetFilepath()));
+    for (const std::string& include : watched.Program->GetIncludes())
+        watched.Files.push_back(WatchFile(include));
+
+    // after the new ones were added, so directories still in use keep their watch
+    for (const WatchedFile& file : previous)
+        ReleaseWatch(file.WatchDescriptor);
+}
+
+ShaderWatcher::WatchedFile ShaderWatcher::WatchFile(const std::string& filepath)
+{
+    const std::filesystem::path path(filepath);
+    WatchedFile file = { path.parent_path(), path.filename().string(), -1, GetWriteTime(path) };
+    if (file.Directory.empty())
+        file.Directory = ".";
+
+#ifdef __linux__
+    // the directory rather than the file, whose inode changes when an editor saves by renaming
+    if (m_Notify >= 0)
+    {
+        file.WatchDescriptor = inotify_add_watch(m_Notify, file.Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (file.WatchDescriptor < 0)
+            std::cout << "Can't watch " << file.Directory.string() << ", polling " << filepath << std::endl;
+    }
+#endif
+    return file;
+}
+
+void ShaderWatcher::ReleaseWatch(int watchDescriptor)
+{
+#ifdef __linux__
+    // inotify returns the same watch for every file in a directory
+    if (watchDescriptor < 0)
+        return;
+    for (const WatchedShader& watched : m_Shaders)
+    {
+        for (const WatchedFile& file : watched.Files)
+        {
+            if (file.WatchDescriptor == watchDescriptor)
+                return;
+        }
+    }
+    inotify_rm_watch(m_Notify, watchDescriptor);
+#else
+    (void)watchDescriptor;
+#endif
+}
+
+void ShaderWatcher::Update()
+{
+    PROFILE_SCOPE("ShaderWatcher::Update");
+
+    ReadNotifications();
+    PollWriteTimes();
+
+    for (WatchedShader& watched : m_Shaders)
+    {
+        // a save can come as several events, it still reloads once
+        if (watched.Changed)
+        {
+            watched.Changed = false;
+            watched.Program->Reload();
+            // the edit may have changed the includes
+            WatchFiles(watched);
+        }
+        // swaps the new program in if it has linked
+        if (watched.Program->IsReloading())
+            watched.Program->GetStatus();
+    }
+}
+
+void ShaderWatcher::ReadNotifications()
+{
+#ifdef __linux__
+    if (m_Notify < 0)
+        return;
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(m_Notify, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t offset = 0; offset < length; )
+        {
+            const inotify_event* event = (const inotify_event*)(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+            if (event->len == 0)
+                continue;
+
+            for (WatchedShader& watched : m_Shaders)
+            {
+                for (const WatchedFile& file : watched.Files)
+                {
+                    if (file.WatchDescriptor == event->wd && file.Name == event->name)
+                        watched.Changed = true;
+                }
+            }
+        }
+    }
+#endif
+}
+
+void ShaderWatcher::PollWriteTimes()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (now - m_LastPoll < PollInterval)
+        return;
+    m_LastPoll = now;
+
+    for (WatchedShader& watched : m_Shaders)
+    {
+        for (WatchedFile& file : watched.Files)
+        {
+            if (file.WatchDescriptor >= 0)
+                continue;
+
+            const std::filesystem::file_time_type writeTime = GetWriteTime(file.Directory / file.Name);
+            if (writeTime != file.WriteTime)
+            {
+                file.WriteTime = writeTime;
+                watched.Changed = true;
+            }
+        }
+    }
+}
+
+std::filesystem::file_time_type ShaderWatcher::GetWriteTime(const std::filesystem::path& path)
+{
+    // a file that is missing for a moment (deleted and written again) isn't an error
+    std::error_code error;
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type::min() : writeTime;
+}
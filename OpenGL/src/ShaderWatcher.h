@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Shader;
+
+// Reloads shaders when their file, or a file it includes, is saved. Opt-in:
+// only shaders passed to Watch() are looked at, and nothing happens outside
+// Update(), which belongs to the thread that owns the context; call it once
+// a frame.
+//
+// On Linux the shaders' directories are watched with inotify (editors that
+// save by renaming a temporary file are seen too). Elsewhere, or if inotify
+// isn't available, the files' modification times are polled twice a second.
+//
+// Shader::Reload() compiles in the background where the driver supports
+// KHR_parallel_shader_compile, and Update() swaps each new program in once
+// it has linked, so a frame never waits for the compiler there.
+class ShaderWatcher
+{
+private:
+	struct WatchedFile
+	{
+		std::filesystem::path Directory;
+		std::string Name;
+		int WatchDescriptor;  // -1 when polled
+		std::filesystem::file_time_type WriteTime;
+	};
+	struct WatchedShader
+	{
+		std::shared_ptr<Shader> Program;
+		std::vector<WatchedFile> Files;  // the .shader file and its includes
+		bool Changed;
+	};
+	std::vector<WatchedShader> m_Shaders;
+	int m_Notify;  // inotify descriptor, -1 when polling
+	std::chrono::steady_clock::time_point m_LastPoll;
+public:
+	ShaderWatcher();
+	~ShaderWatcher();
+
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	// the watcher keeps the shader alive until Unwatch(), so
+	// ShaderLibrary::ReleaseUnused() doesn't free it under the watcher
+	void Watch(const std::shared_ptr<Shader>& shader);
+	void Unwatch(const std::shared_ptr<Shader>& shader);
+
+	// Starts reloading the shaders whose file changed, and finishes reloads
+	// that have linked since the last call.
+	void Update();
+private:
+	// follows the shader's current includes
+	void WatchFiles(WatchedShader& watched);
+	WatchedFile WatchFile(const std::string& filepath);
+	void ReleaseWatch(int watchDescriptor);
+	void ReadNotifications();
+	void PollWriteTimes();
+	static std::filesystem::file_time_type GetWriteTime(const std::filesystem::path& path);
+};
@@ -0,0 +1,126 @@
+#include "StreamBuffer.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount)
+    : m_RendererID(0), m_Target(target), m_RegionSize(regionSize), m_RegionCount(regionCount),
+      m_Region(0), m_Head(0), m_Reserved(0), m_Data(nullptr), m_Fences(regionCount, nullptr)
+{
+    PROFILE_SCOPE("StreamBuffer::StreamBuffer");
+
+    ASSERT(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    if (Renderer::HasDirectStateAccess())
+    {
+        GLCall(glCreateBuffers(1, &m_RendererID));
+        GLCall(glNamedBufferStorage(m_RendererID, (GLsizeiptr)GetSize(), nullptr, flags));
+        GLCall(m_Data = (unsigned char*)glMapNamedBufferRange(m_RendererID, 0, (GLsizeiptr)GetSize(), flags));
+    }
+    else
+    {
+        GLCall(glGenBuffers(1, &m_RendererID));
+        Renderer::State().BindBuffer(m_Target, m_RendererID);
+        GLCall(glBufferStorage(m_Target, (GLsizeiptr)GetSize(), nullptr, flags));
+        GLCall(m_Data = (unsigned char*)glMapBufferRange(m_Target, 0, (GLsizeiptr)GetSize(), flags));
+    }
+    ASSERT(m_Data);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (unsigned int i = 0; i < m_RegionCount; i++)
+    {
+        if (m_Fences[i])
+        {
+            GLCall(glDeleteSync((GLsync)m_Fences[i]));
+        }
+    }
+    // deleting the buffer also unmaps it
+    Renderer::State().DeleteBuffer(m_RendererID);
+}
+
+void* StreamBuffer::Allocate(unsigned int size, unsigned int alignment, unsigned int& offset)
+{
+    void* data = Reserve(size, alignment, offset);
+    if (data)
+        Commit(size);
+    return data;
+}
+
+void* StreamBuffer::Reserve(unsigned int size, unsigned int alignment, unsigned int& offset)
+{
+    const unsigned int head = AlignHead(alignment);
+    if (head + size > m_RegionSize)
+        return nullptr;
+
+    m_Reserved = head;
+    offset = m_Region * m_RegionSize + head;
+    return m_Data + offset;
+}
+
+void StreamBuffer::Commit(unsigned int size)
+{
+    ASSERT(m_Reserved + size <= m_RegionSize);
+    m_Head = m_Reserved + size;
+    Renderer::CountStreamed(size);
+}
+
+unsigned int StreamBuffer::GetAvailable(unsigned int alignment) const
+{
+    const unsigned int head = AlignHead(alignment);
+    return head < m_RegionSize ? m_RegionSize - head : 0;
+}
+
+unsigned int StreamBuffer::AlignHead(unsigned int alignment) const
+{
+    if (alignment <= 1)
+        return m_Head;
+    // the offset from the start of the buffer is what has to be aligned, a
+    // region size that isn't a multiple of the alignment shifts the regions
+    const unsigned int start = m_Region * m_RegionSize;
+    return (start + m_Head + alignment - 1) / alignment * alignment - start;
+}
+
+void StreamBuffer::EndFrame()
+{
+    if (m_Fences[m_Region])
+    {
+        GLCall(glDeleteSync((GLsync)m_Fences[m_Region]));
+    }
+    GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+    m_Region = (m_Region + 1) % m_RegionCount;
+    m_Head = 0;
+    m_Reserved = 0;
+    WaitForRegion(m_Region);
+}
+
+void StreamBuffer::WaitForRegion(unsigned int region)
+{
+    GLsync fence = (GLsync)m_Fences[region];
+    if (!fence)
+        return;
+
+    // first check without flushing, normally the GPU finished this region long ago
+    GLCall(GLenum result = glClientWaitSync(fence, 0, 0));
+    while (result == GL_TIMEOUT_EXPIRED)
+    {
+        GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+    }
+    ASSERT(result != GL_WAIT_FAILED);
+
+    GLCall(glDeleteSync(fence));
+    m_Fences[region] = nullptr;
+}
+
+void StreamBuffer::Bind() const
+{
+    Renderer::State().BindBuffer(m_Target, m_RendererID);
+}
+
+void StreamBuffer::Unbind() const
+{
+    Renderer::State().BindBuffer(m_Target, 0);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+// Persistently mapped buffer split into regions that are written one frame at
+// a time. Each region is fenced when the frame ends, and the region is only
+// waited on when the ring wraps back to it, so with enough regions the CPU
+// never waits for the GPU.
+class StreamBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Target;
+	unsigned int m_RegionSize;
+	unsigned int m_RegionCount;
+	unsigned int m_Region;  // region written this frame
+	unsigned int m_Head;    // next free byte in the region
+	unsigned int m_Reserved;  // start of the last reservation
+	unsigned char* m_Data;
+	std::vector<void*> m_Fences;  // GLsync per region
+public:
+	StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3); // size = bytes
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// Reserves size bytes in the current region and returns a pointer to the
+	// mapped memory, or nullptr if the region is full. offset receives the
+	// position of the allocation from the start of the buffer.
+	void* Allocate(unsigned int size, unsigned int alignment, unsigned int& offset);
+
+	// Same as Allocate, but only the first size bytes passed to Commit() are
+	// actually taken, for writers that don't know up front how much they need.
+	void* Reserve(unsigned int size, unsigned int alignment, unsigned int& offset);
+	void Commit(unsigned int size);
+	// bytes a Reserve() with this alignment can still get from the current region
+	unsigned int GetAvailable(unsigned int alignment) const;
+
+	// Fences the current region after this frame's draws and moves to the next.
+	void EndFrame();
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetTarget() const { return m_Target; }
+	inline unsigned int GetRegionSize() const { return m_RegionSize; }
+	inline unsigned int GetSize() const { return m_RegionSize * m_RegionCount; }
+private:
+	// m_Head moved up so the offset in the buffer is aligned
+	unsigned int AlignHead(unsigned int alignment) const;
+	void WaitForRegion(unsigned int region);
+};
@@ -0,0 +1,97 @@
+#include <cstring>
+
+#include "UniformBuffer.h"
+#include "Renderer.h"
+
+
+static unsigned int AlignUp(unsigned int value, unsigned int alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+unsigned int BlockLayout::Push(BlockMemberType type, unsigned int arrayCount)
+{
+    unsigned int size = 0, alignment = 0;
+    switch (type)
+    {
+        case BlockMemberType::Float:
+        case BlockMemberType::Int:      size = 4;  alignment = 4;  break;
+        case BlockMemberType::Vec2:
+        case BlockMemberType::IVec2:    size = 8;  alignment = 8;  break;
+        case BlockMemberType::Vec3:
+        case BlockMemberType::IVec3:    size = 12; alignment = 16; break;
+        case BlockMemberType::Vec4:
+        case BlockMemberType::IVec4:    size = 16; alignment = 16; break;
+        case BlockMemberType::Mat4:     size = 64; alignment = 16; break;  // four vec4 columns
+    }
+
+    if (arrayCount > 0)
+    {
+        // std140 rounds array elements up to a vec4, std430 only to the element alignment
+        if (m_Rule == BlockLayoutRule::Std140)
+            alignment = AlignUp(alignment, 16);
+        size = AlignUp(size, alignment) * arrayCount;
+    }
+
+    unsigned int offset = AlignUp(m_Size, alignment);
+    m_Size = offset + size;
+    if (alignment > m_Alignment)
+        m_Alignment = alignment;
+    m_Offsets.push_back(offset);
+    return offset;
+}
+
+unsigned int BlockLayout::GetSize() const
+{
+    unsigned int alignment = m_Rule == BlockLayoutRule::Std140 ? AlignUp(m_Alignment, 16) : m_Alignment;
+    return AlignUp(m_Size, alignment);
+}
+
+
+static unsigned int GetOffsetAlignment(unsigned int target)
+{
+    int alignment = 0;
+    if (target == GL_SHADER_STORAGE_BUFFER)
+    {
+        GLCall(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    }
+    else
+    {
+        GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    }
+    return alignment > 0 ? alignment : 256;
+}
+
+UniformBuffer::UniformBuffer(unsigned int target, unsigned int frameSize, unsigned int frameCount)
+    : m_OffsetAlignment(GetOffsetAlignment(target)),
+      // whole alignment units per frame, so every frame's region starts aligned
+      m_Buffer(target, (frameSize + m_OffsetAlignment - 1) / m_OffsetAlignment * m_OffsetAlignment, frameCount)
+{
+}
+
+void* UniformBuffer::Allocate(unsigned int size, unsigned int& offset)
+{
+    return m_Buffer.Allocate(size, m_OffsetAlignment, offset);
+}
+
+void* UniformBuffer::Reserve(unsigned int size, unsigned int& offset)
+{
+    return m_Buffer.Reserve(size, m_OffsetAlignment, offset);
+}
+
+bool UniformBuffer::Upload(unsigned int bindingPoint, const void* data, unsigned int size)
+{
+    unsigned int offset;
+    void* memory = Allocate(size, offset);
+    if (!memory)
+        return false;
+
+    memcpy(memory, data, size);
+    BindRange(bindingPoint, offset, size);
+    return true;
+}
+
+void UniformBuffer::BindRange(unsigned int bindingPoint, unsigned int offset, unsigned int size) const
+{
+    Renderer::State().BindBufferRange(m_Buffer.GetTarget(), bindingPoint, m_Buffer.GetRendererID(), offset, size);
+}
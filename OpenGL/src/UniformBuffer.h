@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "StreamBuffer.h"
+
+enum class BlockLayoutRule
+{
+	Std140, Std430
+};
+
+enum class BlockMemberType
+{
+	Float, Vec2, Vec3, Vec4, Int, IVec2, IVec3, IVec4, Mat4
+};
+
+// Lays out the members of a uniform or shader storage block in declaration
+// order following the std140 or std430 rules, so the C++ side can write
+// each member at the offset the shader expects.
+class BlockLayout
+{
+private:
+	BlockLayoutRule m_Rule;
+	unsigned int m_Size;
+	unsigned int m_Alignment;  // largest member alignment
+	std::vector<unsigned int> m_Offsets;
+public:
+	BlockLayout(BlockLayoutRule rule = BlockLayoutRule::Std140)
+		: m_Rule(rule), m_Size(0), m_Alignment(4) {}
+
+	// arrayCount 0 = not an array; returns the offset of the member
+	unsigned int Push(BlockMemberType type, unsigned int arrayCount = 0);
+
+	// size of the whole block including the padding at the end
+	unsigned int GetSize() const;
+	inline const std::vector<unsigned int>& GetOffsets() const { return m_Offsets; }
+};
+
+// Ring of uniform (or shader storage) buffer memory for per-frame data.
+// Each upload is sub-allocated from the current frame region and attached
+// to a binding point with glBindBufferRange, so camera or material blocks
+// are written once per frame or batch instead of set uniform by uniform.
+class UniformBuffer
+{
+private:
+	unsigned int m_OffsetAlignment;  // queried first, the frame size is rounded up to it
+	StreamBuffer m_Buffer;
+public:
+	// target is GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER
+	UniformBuffer(unsigned int target, unsigned int frameSize, unsigned int frameCount = 3); // size = bytes
+
+	// Returns memory for size bytes of block data; pass offset and size to BindRange
+	void* Allocate(unsigned int size, unsigned int& offset);
+	// Reserve up to size bytes and Commit() what was written, see StreamBuffer
+	void* Reserve(unsigned int size, unsigned int& offset);
+	inline void Commit(unsigned int size) { m_Buffer.Commit(size); }
+	// Copies data into the ring and binds it, returns false if the frame is out of space
+	bool Upload(unsigned int bindingPoint, const void* data, unsigned int size);
+	void BindRange(unsigned int bindingPoint, unsigned int offset, unsigned int size) const;
+
+	inline void EndFrame() { m_Buffer.EndFrame(); }
+	inline unsigned int GetRendererID() const { return m_Buffer.GetRendererID(); }
+};
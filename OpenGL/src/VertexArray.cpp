@@ -1,24 +1,62 @@
+#include <algorithm>
+#include <vector>
+
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "Profiler.h"
 
 VertexArray::VertexArray()
+	: m_AttribCount(0), m_BindingCount(0)
 {
-	GLCall(glGenVertexArrays(1, &m_RendererID));
+	PROFILE_SCOPE("VertexArray::VertexArray");
+
+	if (Renderer::HasDirectStateAccess())
+	{
+		GLCall(glCreateVertexArrays(1, &m_RendererID));
+	}
+	else
+	{
+		GLCall(glGenVertexArrays(1, &m_RendererID));
+	}
 }
 
 VertexArray::~VertexArray()
 {
-	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	Renderer::State().DeleteVertexArray(m_RendererID);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
+	if (Renderer::HasDirectStateAccess())
+	{
+		SetNamedLayout(vb.GetRendererID(), layout);
+		return;
+	}
+
 	// bind vertex array
 	Bind();
 
 	// bind vertex buffer
 	vb.Bind();
 
+	SetLayout(layout);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout)
+{
+	if (Renderer::HasDirectStateAccess())
+	{
+		SetNamedLayout(sb.GetRendererID(), layout);
+		return;
+	}
+
+	Bind();
+	sb.Bind();
+	SetLayout(layout);
+}
+
+void VertexArray::SetLayout(const VertexBufferLayout& layout)
+{
 	// set up layout
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
@@ -26,21 +64,73 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	for (unsigned int i = 0; i < elements.size(); i++)
 	{
 		const auto& element = elements[i];
-		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, element.count, element.type,
-			element.normalized, layout.GetStride(), (const void*)offset));
+		const unsigned int index = m_AttribCount + i;
+		GLCall(glEnableVertexAttribArray(index));
+		GLCall(glVertexAttribPointer(index, element.count, element.type,
+			element.normalized, layout.GetStride(), (const void*)(uintptr_t)offset));
+		if (element.divisor)
+		{
+			GLCall(glVertexAttribDivisor(index, element.divisor));
+		}
 		offset += VertexBufferElement::GetSizeOfType(element.type) * element.count;
 	}
+	m_AttribCount += (unsigned int)elements.size();
 
 }
 
+void VertexArray::SetNamedLayout(unsigned int buffer, const VertexBufferLayout& layout)
+{
+	// the divisor belongs to the buffer binding point, so attributes with
+	// different divisors read the same buffer through binding points of their own
+	const auto& elements = layout.GetElements();
+	std::vector<unsigned int> divisors;
+	unsigned int offset = 0;
+
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const auto& element = elements[i];
+		const unsigned int index = m_AttribCount + i;
+
+		auto it = std::find(divisors.begin(), divisors.end(), element.divisor);
+		const unsigned int binding = m_BindingCount + (unsigned int)(it - divisors.begin());
+		if (it == divisors.end())
+		{
+			divisors.push_back(element.divisor);
+			GLCall(glVertexArrayVertexBuffer(m_RendererID, binding, buffer, 0, layout.GetStride()));
+			if (element.divisor)
+			{
+				GLCall(glVertexArrayBindingDivisor(m_RendererID, binding, element.divisor));
+			}
+		}
+
+		GLCall(glEnableVertexArrayAttrib(m_RendererID, index));
+		GLCall(glVertexArrayAttribFormat(m_RendererID, index, element.count, element.type, element.normalized, offset));
+		GLCall(glVertexArrayAttribBinding(m_RendererID, index, binding));
+		offset += VertexBufferElement::GetSizeOfType(element.type) * element.count;
+	}
+	m_AttribCount += (unsigned int)elements.size();
+	m_BindingCount += (unsigned int)divisors.size();
+}
+
+void VertexArray::SetIndexBuffer(const IndexBuffer& ib)
+{
+	if (Renderer::HasDirectStateAccess())
+	{
+		Renderer::State().SetElementBuffer(m_RendererID, ib.GetRendererID());
+		return;
+	}
+
+	Bind();
+	ib.Bind();
+}
+
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	Renderer::State().BindVertexArray(m_RendererID);
 }
 
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	Renderer::State().BindVertexArray(0);
 }
@@ -1,18 +1,32 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "StreamBuffer.h"
 #include "VertexBufferLayout.h"
 
 class VertexArray
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttribCount;  // buffers added later continue from this attribute index
+	unsigned int m_BindingCount; // vertex buffer binding points used, direct state access only
 public:
 	VertexArray();
 	~VertexArray();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout);
+	// Attaches the index buffer up front; drawing still binds it, which the
+	// state cache then skips.
+	void SetIndexBuffer(const IndexBuffer& ib);
 	void Bind() const;
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+private:
+	void SetLayout(const VertexBufferLayout& layout);
+	// direct state access, without binding anything
+	void SetNamedLayout(unsigned int buffer, const VertexBufferLayout& layout);
+
 };
\ No newline at end of file
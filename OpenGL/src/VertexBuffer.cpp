@@ -1,26 +1,39 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "Profiler.h"
 
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
-    GLCall(glGenBuffers(1, &m_RendererID));  // &iBuffer = generoidun bufferin ID
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));  // binding = valitaan
-    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+    PROFILE_SCOPE("VertexBuffer::VertexBuffer");
+
+    if (Renderer::HasDirectStateAccess())
+    {
+        // never written again, so the storage can be immutable
+        GLCall(glCreateBuffers(1, &m_RendererID));
+        GLCall(glNamedBufferStorage(m_RendererID, size, data, 0));
+    }
+    else
+    {
+        GLCall(glGenBuffers(1, &m_RendererID));  // &iBuffer = generoidun bufferin ID
+        Renderer::State().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);  // binding = valitaan
+        GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+    }
+    Renderer::CountUpload(size);
 
 }
 
 VertexBuffer::~VertexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    Renderer::State().DeleteBuffer(m_RendererID);
 }
 
 void VertexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    Renderer::State().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    Renderer::State().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -10,4 +10,6 @@ public:
 
 	void Bind() const; 
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <stdexcept>
 #include "Renderer.h"
 
 #include <vector>
@@ -10,6 +9,7 @@ struct VertexBufferElement
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	unsigned int divisor;  // 0 = per vertex, n = advances once every n instances
 
 	static unsigned int GetSizeOfType(unsigned int type)
 	{
@@ -37,31 +37,39 @@ public:
 	template<typename T>
 	void Push(unsigned int count)
 	{
-		std::runtime_error(false);
-		//static_assert(false);
+		static_assert(sizeof(T) == 0, "Unsupported vertex attribute type");
 	}
 
-	template<>
-	void Push<float>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_Stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
-	}
-
-	template<>
-	void Push<unsigned int>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
-	}
-
-	template<>
-	void Push<unsigned char>(unsigned int count)
+	// per-instance attribute, e.g. a transform or color for instanced draws
+	template<typename T>
+	void PushInstanced(unsigned int count, unsigned int divisor = 1)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
+		Push<T>(count);
+		m_Elements.back().divisor = divisor;
 	}
 
 	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
-};
\ No newline at end of file
+};
+
+// specializations live at namespace scope, in-class explicit specialization is an MSVC extension
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count)
+{
+	m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, 0 });
+	m_Stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count)
+{
+	m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, 0 });
+	m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int count)
+{
+	m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, 0 });
+	m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
+}
\ No newline at end of file
@@ -0,0 +1,344 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "IndexBuffer.h"
+#include "Material.h"
+#include "NullGL.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "ShaderParser.h"
+#include "UniformBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+// CPU-side tests of the renderer against NullGL, run from the tests directory:
+//   ctest --test-dir build
+// or ../../build/RendererTests to run them by hand.
+
+static unsigned int s_Checks = 0;
+static unsigned int s_Failures = 0;
+
+#define CHECK(x) Check((x), #x, __FILE__, __LINE__)
+#define CHECK_EQUAL(a, b) CheckEqual((a), (b), #a, #b, __FILE__, __LINE__)
+
+static void Check(bool passed, const char* expression, const char* file, int line)
+{
+    s_Checks++;
+    if (passed)
+        return;
+    s_Failures++;
+    std::cout << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+}
+
+template<typename A, typename B>
+static void CheckEqual(const A& a, const B& b, const char* expressionA, const char* expressionB, const char* file, int line)
+{
+    s_Checks++;
+    if (a == b)
+        return;
+    s_Failures++;
+    std::cout << file << ":" << line << ": " << expressionA << " == " << expressionB <<
+        " failed, " << a << " != " << b << std::endl;
+}
+
+static std::string JoinPieces(const ShaderStageSource& stage)
+{
+    std::string text;
+    for (std::string_view piece : stage.Pieces)
+        text.append(piece);
+    return text;
+}
+
+static unsigned int CountOccurrences(const std::string& text, const char* word)
+{
+    unsigned int count = 0;
+    for (size_t i = text.find(word); i != std::string::npos; i = text.find(word, i + 1))
+        count++;
+    return count;
+}
+
+
+static void TestVertexBufferLayout()
+{
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<unsigned char>(4);
+    layout.PushInstanced<float>(4, 2);
+
+    const auto& elements = layout.GetElements();
+    CHECK_EQUAL(elements.size(), 3u);
+    CHECK_EQUAL(layout.GetStride(), 3 * 4u + 4 * 1u + 4 * 4u);
+    CHECK_EQUAL(elements[1].type, (unsigned int)GL_UNSIGNED_BYTE);
+    CHECK_EQUAL((int)elements[1].normalized, GL_TRUE);
+    CHECK_EQUAL(elements[0].divisor, 0u);
+    CHECK_EQUAL(elements[2].divisor, 2u);
+}
+
+// glVertexAttribPointer: offsets within the stride, and a second buffer
+// continuing from the attributes of the first
+static void TestVertexArrayBindToEdit()
+{
+    Renderer::SetDirectStateAccess(false);
+
+    const float data[16] = {};
+    VertexBuffer positions(data, sizeof(data));
+    VertexBuffer colors(data, sizeof(data));
+
+    VertexBufferLayout vertexLayout;
+    vertexLayout.Push<float>(2);
+    vertexLayout.Push<float>(2);
+    VertexBufferLayout instanceLayout;
+    instanceLayout.PushInstanced<float>(4);
+
+    VertexArray va;
+    va.AddBuffer(positions, vertexLayout);
+    va.AddBuffer(colors, instanceLayout);
+
+    NullGLVertexAttrib position = NullGL::GetVertexAttrib(va.GetRendererID(), 0);
+    NullGLVertexAttrib texCoord = NullGL::GetVertexAttrib(va.GetRendererID(), 1);
+    NullGLVertexAttrib color = NullGL::GetVertexAttrib(va.GetRendererID(), 2);
+
+    CHECK(position.Enabled && texCoord.Enabled && color.Enabled);
+    CHECK(!NullGL::GetVertexAttrib(va.GetRendererID(), 3).Enabled);
+    CHECK_EQUAL(position.Buffer, positions.GetRendererID());
+    CHECK_EQUAL(position.Size, 2);
+    CHECK_EQUAL(position.Stride, 16);
+    CHECK_EQUAL(position.Offset, 0u);
+    CHECK_EQUAL(texCoord.Offset, 8u);
+    CHECK_EQUAL(texCoord.Divisor, 0u);
+    CHECK_EQUAL(color.Buffer, colors.GetRendererID());
+    CHECK_EQUAL(color.Size, 4);
+    CHECK_EQUAL(color.Offset, 0u);
+    CHECK_EQUAL(color.Divisor, 1u);
+
+    Renderer::SetDirectStateAccess(true);
+}
+
+// direct state access: one binding point per divisor in a buffer, numbered
+// on across AddBuffer calls
+static void TestVertexArrayDirectStateAccess()
+{
+    CHECK(Renderer::HasDirectStateAccess());
+
+    const float data[16] = {};
+    VertexBuffer interleaved(data, sizeof(data));
+    VertexBuffer instances(data, sizeof(data));
+
+    VertexBufferLayout interleavedLayout;
+    interleavedLayout.Push<float>(3);
+    interleavedLayout.PushInstanced<float>(4, 1);
+    interleavedLayout.PushInstanced<float>(1, 2);
+    interleavedLayout.Push<float>(2);
+    VertexBufferLayout instanceLayout;
+    instanceLayout.PushInstanced<float>(4);
+
+    NullGL::ClearCalls();
+    VertexArray va;
+    va.AddBuffer(interleaved, interleavedLayout);
+    va.AddBuffer(instances, instanceLayout);
+
+    const unsigned int expectedBindings[] = { 0, 1, 2, 0, 3 };
+    const unsigned int expectedDivisors[] = { 0, 1, 2, 0, 1 };
+    const unsigned int expectedOffsets[] = { 0, 12, 28, 32, 0 };
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        NullGLVertexAttrib attrib = NullGL::GetVertexAttrib(va.GetRendererID(), i);
+        CHECK(attrib.Enabled);
+        CHECK_EQUAL(attrib.Binding, expectedBindings[i]);
+        CHECK_EQUAL(attrib.Divisor, expectedDivisors[i]);
+        CHECK_EQUAL(attrib.Offset, expectedOffsets[i]);
+        CHECK_EQUAL(attrib.Buffer, i < 4 ? interleaved.GetRendererID() : instances.GetRendererID());
+        CHECK_EQUAL(attrib.Stride, i < 4 ? 40 : 16);
+    }
+    CHECK_EQUAL(NullGL::CountCalls("glVertexArrayVertexBuffer"), 4u);
+    CHECK_EQUAL(NullGL::CountCalls("glVertexArrayBindingDivisor"), 3u);
+    CHECK_EQUAL(NullGL::CountCalls("glBindVertexArray"), 0u);
+}
+
+static void TestShaderParser()
+{
+    ShaderProgramSource source = ShaderParser::Parse("res/Test.shader", ShaderDefines({ "INSTANCED" }));
+
+    CHECK_EQUAL(source.Stages.size(), 2u);
+    const ShaderStageSource* vertex = source.FindStage(GL_VERTEX_SHADER);
+    const ShaderStageSource* fragment = source.FindStage(GL_FRAGMENT_SHADER);
+    CHECK(vertex && fragment);
+    if (!vertex || !fragment)
+        return;
+    CHECK_EQUAL(source.Stages[0].Type, (unsigned int)GL_VERTEX_SHADER);
+
+    const std::string vertexText = JoinPieces(*vertex);
+    const std::string fragmentText = JoinPieces(*fragment);
+    CHECK_EQUAL(vertexText.compare(0, 17, "#version 410 core"), 0);
+    CHECK(vertexText.find("Lines before") == std::string::npos);
+    CHECK(vertexText.find("u_Color") == std::string::npos);
+    CHECK(fragmentText.find("in vec4 position") == std::string::npos);
+
+    // Common.glsl directly and again through Header.glsl, but once per stage
+    CHECK_EQUAL(CountOccurrences(vertexText, "vec4 Offset("), 1u);
+    CHECK_EQUAL(CountOccurrences(fragmentText, "vec4 Offset("), 1u);
+    CHECK_EQUAL(CountOccurrences(vertexText, "#include"), 0u);
+    CHECK_EQUAL(source.Includes.size(), 2u);
+
+    // after #version, in each stage
+    CHECK_EQUAL(CountOccurrences(vertexText, "#define INSTANCED 1"), 1u);
+    CHECK_EQUAL(CountOccurrences(fragmentText, "#define INSTANCED 1"), 1u);
+    CHECK(vertexText.find("#define INSTANCED 1") > vertexText.find("#version"));
+}
+
+static void TestBlockLayout()
+{
+    const BlockMemberType members[] = { BlockMemberType::Float, BlockMemberType::Vec3, BlockMemberType::Float,
+        BlockMemberType::Vec2, BlockMemberType::Float, BlockMemberType::Mat4 };
+    const unsigned int arrayCounts[] = { 0, 0, 0, 0, 3, 0 };
+
+    // std140 pads float[3] to a vec4 per element
+    const unsigned int std140Offsets[] = { 0, 16, 28, 32, 48, 96 };
+    BlockLayout std140(BlockLayoutRule::Std140);
+    for (unsigned int i = 0; i < 6; i++)
+        CHECK_EQUAL(std140.Push(members[i], arrayCounts[i]), std140Offsets[i]);
+    CHECK_EQUAL(std140.GetSize(), 160u);
+
+    const unsigned int std430Offsets[] = { 0, 16, 28, 32, 40, 64 };
+    BlockLayout std430(BlockLayoutRule::Std430);
+    for (unsigned int i = 0; i < 6; i++)
+        CHECK_EQUAL(std430.Push(members[i], arrayCounts[i]), std430Offsets[i]);
+    CHECK_EQUAL(std430.GetSize(), 128u);
+
+    // std140 rounds the block up to a vec4, std430 to its largest member
+    BlockLayout small140(BlockLayoutRule::Std140), small430(BlockLayoutRule::Std430);
+    small140.Push(BlockMemberType::Vec2);
+    small140.Push(BlockMemberType::Float);
+    small430.Push(BlockMemberType::Vec2);
+    small430.Push(BlockMemberType::Float);
+    CHECK_EQUAL(small140.GetSize(), 16u);
+    CHECK_EQUAL(small430.GetSize(), 16u);
+    CHECK_EQUAL(small430.GetOffsets()[1], 8u);
+}
+
+static void TestStateCache()
+{
+    StateCache& state = Renderer::State();
+    state.Invalidate();
+    state.ResetStats();
+    NullGL::ClearCalls();
+
+    for (int i = 0; i < 3; i++)
+    {
+        state.UseProgram(100);
+        state.BindVertexArray(101);
+        state.BindBuffer(GL_ARRAY_BUFFER, 102);
+        state.BindTexture(1, GL_TEXTURE_2D, 103);
+        state.BindBufferRange(GL_UNIFORM_BUFFER, 0, 104, 256, 64);
+    }
+    state.BindBufferRange(GL_UNIFORM_BUFFER, 0, 104, 512, 64);
+
+    const StateCacheStats& stats = state.GetStats();
+    CHECK_EQUAL(stats.ProgramBinds, 1u);
+    CHECK_EQUAL(stats.ProgramBindsElided, 2u);
+    CHECK_EQUAL(stats.VertexArrayBindsElided, 2u);
+    CHECK_EQUAL(stats.BufferBindsElided, 2u);
+    CHECK_EQUAL(stats.TextureBindsElided, 2u);
+    CHECK_EQUAL(stats.BufferRangeBinds, 2u);
+    CHECK_EQUAL(stats.BufferRangeBindsElided, 2u);
+    CHECK_EQUAL(NullGL::CountCalls("glUseProgram"), 1u);
+    CHECK_EQUAL(NullGL::CountCalls("glBindVertexArray"), 1u);
+    CHECK_EQUAL(NullGL::CountCalls("glBindTexture"), 1u);
+
+    // deleting what is bound makes the next bind reach GL again
+    state.DeleteProgram(100);
+    state.UseProgram(100);
+    CHECK_EQUAL(NullGL::CountCalls("glUseProgram"), 2u);
+
+    state.Invalidate();
+}
+
+static void TestUniformShadowing()
+{
+    NullGL::Config().Uniforms = { "u_Color" };
+    Shader shader("res/Test.shader");
+    NullGL::Config().Uniforms.clear();
+
+    CHECK(shader.IsReady());
+    CHECK(shader.FindUniform("u_Color") != nullptr);
+
+    NullGL::ClearCalls();
+    shader.SetUniform4f("u_Color", 1.0f, 0.0f, 0.0f, 1.0f);
+    shader.SetUniform4f("u_Color", 1.0f, 0.0f, 0.0f, 1.0f);
+    CHECK_EQUAL(NullGL::CountCalls("glProgramUniform4fv"), 1u);
+    shader.SetUniform4f("u_Color", 0.0f, 1.0f, 0.0f, 1.0f);
+    CHECK_EQUAL(NullGL::CountCalls("glProgramUniform4fv"), 2u);
+
+    // deferred: only the last value is uploaded, and only if it changed
+    shader.SetDeferredUniforms(true);
+    shader.SetUniform4f("u_Color", 0.0f, 0.0f, 1.0f, 1.0f);
+    shader.SetUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+    CHECK_EQUAL(NullGL::CountCalls("glProgramUniform4fv"), 2u);
+    shader.FlushUniforms();
+    CHECK_EQUAL(NullGL::CountCalls("glProgramUniform4fv"), 3u);
+    shader.SetUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+    shader.FlushUniforms();
+    CHECK_EQUAL(NullGL::CountCalls("glProgramUniform4fv"), 3u);
+}
+
+// draws sharing a program, vertex array and material bind and upload once
+static void TestRendererFlush()
+{
+    NullGL::Config().Uniforms = { "u_Color" };
+    Shader shader("res/Test.shader");
+    NullGL::Config().Uniforms.clear();
+
+    const float positions[8] = {};
+    const unsigned int indices[6] = { 0, 1, 2, 2, 3, 0 };
+    VertexBuffer vb(positions, sizeof(positions));
+    VertexBufferLayout layout;
+    layout.Push<float>(2);
+    VertexArray va;
+    va.AddBuffer(vb, layout);
+    IndexBuffer ib(indices, 6);
+
+    UniformHandle color("u_Color");
+    Material red, green;
+    red.SetUniform4f(color, 1.0f, 0.0f, 0.0f, 1.0f);
+    green.SetUniform4f(color, 0.0f, 1.0f, 0.0f, 1.0f);
+
+    Renderer renderer;
+    Renderer::State().Invalidate();
+    NullGL::ClearCalls();
+    for (int i = 0; i < 4; i++)
+    {
+        renderer.Submit(shader, va, ib, &green);
+        renderer.Submit(shader, va, ib, &red);
+    }
+    renderer.Flush();
+
+    CHECK_EQUAL(NullGL::CountCalls("glDrawElements"), 8u);
+    CHECK_EQUAL(NullGL::CountCalls("glUseProgram"), 1u);
+    CHECK_EQUAL(NullGL::CountCalls("glBindVertexArray"), 1u);
+    // sorted by material, so the color changes once
+    CHECK_EQUAL(NullGL::CountCalls("glProgramUniform4fv"), 2u);
+    Renderer::EndFrame();
+}
+
+
+int main()
+{
+    NullGL::Install();
+    NullGL::SetRecording(true);
+
+    TestVertexBufferLayout();
+    TestVertexArrayBindToEdit();
+    TestVertexArrayDirectStateAccess();
+    TestShaderParser();
+    TestBlockLayout();
+    TestStateCache();
+    TestUniformShadowing();
+    TestRendererFlush();
+
+    NullGL::Uninstall();
+
+    std::cout << s_Checks - s_Failures << "/" << s_Checks << " checks passed" << std::endl;
+    return s_Failures == 0 ? 0 : 1;
+}
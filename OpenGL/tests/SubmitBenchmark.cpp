@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "IndexBuffer.h"
+#include "Material.h"
+#include "NullGL.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+// CPU cost of Renderer::Submit + Flush with NullGL behind it, so the time is
+// the renderer's own: sorting, state cache, uniform shadowing and the GLCall
+// wrapper. Run from the tests directory:
+//   SubmitBenchmark [--frames N] [--draws N] [--shaders N] [--vertex-arrays N] [--materials N]
+
+struct BenchmarkOptions
+{
+    int Frames = 1000;
+    int Draws = 2000;         // per frame
+    int Shaders = 4;
+    int VertexArrays = 16;
+    int Materials = 64;
+};
+
+static BenchmarkOptions ParseOptions(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            options.Frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--draws") == 0 && i + 1 < argc)
+            options.Draws = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--shaders") == 0 && i + 1 < argc)
+            options.Shaders = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--vertex-arrays") == 0 && i + 1 < argc)
+            options.VertexArrays = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--materials") == 0 && i + 1 < argc)
+            options.Materials = atoi(argv[++i]);
+        else
+            std::cout << "Unknown option " << argv[i] << std::endl;
+    }
+    return options;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options = ParseOptions(argc, argv);
+    if (options.Frames < 1 || options.Draws < 1 || options.Shaders < 1 || options.VertexArrays < 1 || options.Materials < 1)
+    {
+        std::cout << "Counts have to be at least 1" << std::endl;
+        return 1;
+    }
+
+    NullGLConfig config;
+    config.Uniforms = { "u_Color" };
+    NullGL::Install(config);
+    {
+        // variants of one file, so each is a program of its own
+        std::vector<std::unique_ptr<Shader>> shaders;
+        for (int i = 0; i < options.Shaders; i++)
+            shaders.push_back(std::make_unique<Shader>("res/Test.shader", ShaderDefines().Set("VARIANT", i)));
+
+        const float positions[8] = { -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f };
+        const unsigned int indices[6] = { 0, 1, 2, 2, 3, 0 };
+        VertexBufferLayout layout;
+        layout.Push<float>(2);
+        std::vector<std::unique_ptr<VertexBuffer>> vertexBuffers;
+        std::vector<std::unique_ptr<VertexArray>> vertexArrays;
+        for (int i = 0; i < options.VertexArrays; i++)
+        {
+            vertexBuffers.push_back(std::make_unique<VertexBuffer>(positions, (unsigned int)sizeof(positions)));
+            vertexArrays.push_back(std::make_unique<VertexArray>());
+            vertexArrays.back()->AddBuffer(*vertexBuffers.back(), layout);
+        }
+        IndexBuffer ib(indices, 6);
+
+        UniformHandle color("u_Color");
+        std::vector<Material> materials(options.Materials);
+        for (int i = 0; i < options.Materials; i++)
+            materials[i].SetUniform4f(color, (float)i / options.Materials, 0.5f, 0.5f, 1.0f);
+
+        Renderer renderer;
+        NullGL::ClearCalls();
+        unsigned int uniformUploads = 0, bindsElided = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < options.Frames; frame++)
+        {
+            // strided so consecutive submits differ and the sort has work to do
+            for (int i = 0; i < options.Draws; i++)
+            {
+                renderer.Submit(*shaders[i % options.Shaders], *vertexArrays[(i * 7) % options.VertexArrays],
+                    ib, &materials[(i * 13) % options.Materials]);
+            }
+            renderer.Flush();
+            Renderer::EndFrame();
+
+            const RendererStats& stats = Renderer::GetFrameStats();
+            const StateCacheStats& binds = stats.Binds;
+            uniformUploads += stats.UniformUploads;
+            bindsElided += binds.ProgramBindsElided + binds.VertexArrayBindsElided + binds.BufferBindsElided +
+                binds.BufferRangeBindsElided + binds.TextureBindsElided;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        const double draws = (double)options.Frames * options.Draws;
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << options.Frames << " frames of " << options.Draws << " draws (" << options.Shaders << " shaders, " <<
+            options.VertexArrays << " vertex arrays, " << options.Materials << " materials)" << std::endl;
+        std::cout << "  " << seconds * 1e9 / draws << " ns per draw, " << seconds * 1e3 / options.Frames << " ms per frame" << std::endl;
+        std::cout << "  " << NullGL::GetCallCount() / draws << " GL calls, " << uniformUploads / draws <<
+            " uniform uploads, " << bindsElided / draws << " binds elided per draw" << std::endl;
+    }
+    NullGL::Uninstall();
+    return 0;
+}
@@ -0,0 +1,4 @@
+vec4 Offset(vec4 v)
+{
+    return v + vec4(0.5, 0.5, 0.0, 0.0);
+}
@@ -0,0 +1 @@
+#include "Common.glsl"
@@ -0,0 +1,26 @@
+Lines before the first stage are ignored.
+
+#shader vertex
+#version 410 core
+#include "Common.glsl"
+#include "Header.glsl"
+
+layout(location = 0) in vec4 position;
+
+void main()
+{
+    gl_Position = Offset(position);
+};
+
+#shader fragment
+#version 410 core
+#include "Header.glsl"
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+    color = Offset(u_Color);
+};